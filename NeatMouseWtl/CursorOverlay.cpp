@@ -9,7 +9,14 @@
 
 
 #include "StdAfx.h"
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <mutex>
+
 #include "CursorOverlay.h"
+#include "logic/GridTargeting.h"
 #include "logic/MainSingleton.h"
 #include "neatcommon/ui/CustomizedControls.h"
 #include "resource.h"
@@ -18,22 +25,298 @@ namespace neatmouse {
 
 namespace {
 	HINSTANCE overlayInstance = NULL;
-	HWND overlayHwnd = NULL;
+	std::atomic<HWND> overlayHwnd{ NULL };
 	HHOOK mouseHook = NULL;
 	HANDLE threadHandle = NULL;
 	HBITMAP overlayBitmap = NULL;
 	constexpr LPWSTR OVERLAY_WINDOW_NAME = L"NeatOverlay";
+	constexpr LPWSTR GRID_WINDOW_NAME = L"NeatTargetingGrid";
 	constexpr auto WM_NEATMOUSE_OVERLAY_REDRAW = WM_USER + 1;
+	constexpr auto WM_NEATMOUSE_OVERLAY_SHOW = WM_USER + 2;
+	constexpr auto WM_NEATMOUSE_OVERLAY_HIDE = WM_USER + 3;
+	constexpr auto WM_NEATMOUSE_GRID_UPDATE = WM_USER + 4;
+	constexpr UINT_PTR REDRAW_TIMER_ID = 1;
+	constexpr UINT_PTR RECONCILE_TIMER_ID = 2;
+
+	// redraw requests are coalesced: only the first request after a redraw posts a message
+	std::atomic<bool> redrawPending{ false };
+	std::atomic<unsigned long> redrawsRequested{ 0 };
+	std::atomic<unsigned long> redrawsPosted{ 0 };
+	std::atomic<unsigned long> redrawsServiced{ 0 };
+
+	// predicted cursor position: the overlay thread stores the real one, the emulation adds the moves it injects;
+	// the seqlock lets the overlay read a consistent pair without ever blocking the threads moving the cursor
+	std::atomic<unsigned long> positionSequence{ 0 };
+	std::atomic<LONG> predictedX{ 0 };
+	std::atomic<LONG> predictedY{ 0 };
+	std::atomic<bool> reconcileRequested{ true };
+
+	// injected moves are subject to the pointer acceleration and to the DPI virtualization, so the prediction
+	// is checked against the real position from time to time even if the mouse itself doesn't move
+	constexpr std::chrono::milliseconds kReconcilePeriod(250);
+
+	// used by the overlay thread only
+	bool overlayVisible = false;
+	int cursorOffsetX = 0;
+	int cursorOffsetY = 0;
+	std::chrono::steady_clock::duration framePeriod;
+	std::chrono::steady_clock::time_point lastRedrawTime;
+	std::chrono::steady_clock::time_point lastReconcileTime;
+	POINT lastPosition = { 0, 0 };
+	RECT screenBounds = { 0, 0, 0, 0 };
+	bool redrawTimerSet = false;
+
+	// grid of the targeting mode: requested by the emulation, drawn by the overlay thread; a size of 0 hides it
+	std::mutex gridMutex;
+	RECT requestedGridRegion = { 0, 0, 0, 0 };
+	int requestedGridSize = 0;
+	HWND gridHwnd = NULL;
+
+	// surface of the grid, used by the overlay thread only: it is kept while the grid is shown, tinted all over, and
+	// only the lines are redrawn when the region is narrowed down; it is released once the grid is hidden, since it
+	// may be as large as the monitor
+	HBITMAP gridBitmap = NULL;
+	DWORD * gridPixels = nullptr;
+	LONG gridSurfaceWidth = 0;
+	LONG gridSurfaceHeight = 0;
+	RECT drawnGridRegion = { 0, 0, 0, 0 };
+	int drawnGridSize = 0;
+
+	// premultiplied ARGB: a light tint over the region, and the lines between the cells
+	constexpr DWORD kGridFillColor = 0x40001E36;
+	constexpr DWORD kGridLineColor = 0xC0005AA1;
+
+	template <class UpdateFn>
+	void WritePosition(UpdateFn update)
+	{
+		// there may be several writers, an odd sequence number means one of them is busy
+		unsigned long seq = positionSequence.load(std::memory_order_relaxed);
+		while (((seq & 1) != 0) || !positionSequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire))
+		{
+			YieldProcessor();
+			seq = positionSequence.load(std::memory_order_relaxed);
+		}
+		update();
+		positionSequence.store(seq + 2, std::memory_order_release);
+	}
+
+	POINT ReadPosition()
+	{
+		for (;;)
+		{
+			const unsigned long seq = positionSequence.load(std::memory_order_acquire);
+			if ((seq & 1) == 0)
+			{
+				const POINT pt = { predictedX.load(std::memory_order_relaxed), predictedY.load(std::memory_order_relaxed) };
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (positionSequence.load(std::memory_order_relaxed) == seq) return pt;
+			}
+			YieldProcessor();
+		}
+	}
+
+	void UpdateCursorMetrics()
+	{
+		cursorOffsetX = GetSystemMetrics(SM_CXCURSOR) / 2;
+		cursorOffsetY = GetSystemMetrics(SM_CYCURSOR) / 2;
+
+		HDC hdc = GetDC(NULL);
+		int refreshRate = GetDeviceCaps(hdc, VREFRESH);
+		ReleaseDC(NULL, hdc);
+		// 0 and 1 stand for the default refresh rate of the hardware
+		if (refreshRate <= 1) refreshRate = 60;
+		framePeriod = std::chrono::microseconds(1000000 / refreshRate);
+
+		screenBounds.left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+		screenBounds.top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+		screenBounds.right = screenBounds.left + GetSystemMetrics(SM_CXVIRTUALSCREEN) - 1;
+		screenBounds.bottom = screenBounds.top + GetSystemMetrics(SM_CYVIRTUALSCREEN) - 1;
+	}
+
+	void RedrawOverlay(HWND hWnd)
+	{
+		if (!overlayVisible)
+		{
+			redrawPending.store(false);
+			return;
+		}
+
+		// no more than one redraw per frame; a request coming earlier is serviced by the timer when the frame is due
+		const auto now = std::chrono::steady_clock::now();
+		const auto sinceLastRedraw = now - lastRedrawTime;
+		if (sinceLastRedraw < framePeriod)
+		{
+			if (!redrawTimerSet)
+			{
+				const auto waitTime = std::chrono::duration_cast<std::chrono::milliseconds>(framePeriod - sinceLastRedraw);
+				SetTimer(hWnd, REDRAW_TIMER_ID, static_cast<UINT>(waitTime.count()) + 1, NULL);
+				redrawTimerSet = true;
+			}
+			return;
+		}
+
+		if (redrawTimerSet)
+		{
+			KillTimer(hWnd, REDRAW_TIMER_ID);
+			redrawTimerSet = false;
+		}
+		lastRedrawTime = now;
+
+		// the flag is cleared before the cursor position is read, so that any later move requests a new redraw
+		redrawPending.store(false);
+		++redrawsServiced;
+
+		if (reconcileRequested.exchange(false) || (now - lastReconcileTime >= kReconcilePeriod))
+		{
+			POINT realPt;
+			GetCursorPos(&realPt);
+			WritePosition([&realPt]()
+			{
+				predictedX.store(realPt.x, std::memory_order_relaxed);
+				predictedY.store(realPt.y, std::memory_order_relaxed);
+			});
+			lastReconcileTime = now;
+		} else
+		{
+			// check the prediction once more when the cursor comes to rest
+			SetTimer(hWnd, RECONCILE_TIMER_ID, static_cast<UINT>(kReconcilePeriod.count()), NULL);
+		}
+
+		// the prediction may overshoot the edges of the screen until it is reconciled
+		POINT pt = ReadPosition();
+		if (pt.x < screenBounds.left) pt.x = screenBounds.left; else
+		if (pt.x > screenBounds.right) pt.x = screenBounds.right;
+		if (pt.y < screenBounds.top) pt.y = screenBounds.top; else
+		if (pt.y > screenBounds.bottom) pt.y = screenBounds.bottom;
+		if ((pt.x == lastPosition.x) && (pt.y == lastPosition.y)) return;
+		lastPosition = pt;
+
+		SetWindowPos(hWnd, HWND_TOPMOST, pt.x + cursorOffsetX, pt.y + cursorOffsetY, 0, 0, SWP_SHOWWINDOW | SWP_NOSIZE);
+	}
+
+	void FillPixels(DWORD * pixels, LONG stride, LONG left, LONG top, LONG right, LONG bottom, DWORD color)
+	{
+		for (LONG y = top; y < bottom; ++y)
+		{
+			DWORD * row = pixels + y * stride;
+			for (LONG x = left; x < right; ++x) row[x] = color;
+		}
+	}
+
+	bool ReserveGridSurface(HDC hdc, LONG width, LONG height)
+	{
+		if (gridBitmap && (width <= gridSurfaceWidth) && (height <= gridSurfaceHeight)) return true;
+
+		const LONG surfaceWidth = (width > gridSurfaceWidth) ? width : gridSurfaceWidth;
+		const LONG surfaceHeight = (height > gridSurfaceHeight) ? height : gridSurfaceHeight;
+
+		BITMAPINFO bitmapInfo{};
+		bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		bitmapInfo.bmiHeader.biWidth = surfaceWidth;
+		bitmapInfo.bmiHeader.biHeight = -surfaceHeight;
+		bitmapInfo.bmiHeader.biPlanes = 1;
+		bitmapInfo.bmiHeader.biBitCount = 32;
+		bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+		void * bits = nullptr;
+		HBITMAP hBitmap = CreateDIBSection(hdc, &bitmapInfo, DIB_RGB_COLORS, &bits, NULL, 0);
+		if (!hBitmap) return false;
+
+		if (gridBitmap) DeleteObject(gridBitmap);
+		gridBitmap = hBitmap;
+		gridPixels = static_cast<DWORD *>(bits);
+		gridSurfaceWidth = surfaceWidth;
+		gridSurfaceHeight = surfaceHeight;
+		drawnGridSize = 0;
+		FillPixels(gridPixels, gridSurfaceWidth, 0, 0, gridSurfaceWidth, gridSurfaceHeight, kGridFillColor);
+		return true;
+	}
+
+	void ReleaseGridSurface()
+	{
+		if (gridBitmap) DeleteObject(gridBitmap);
+		gridBitmap = NULL;
+		gridPixels = nullptr;
+		gridSurfaceWidth = gridSurfaceHeight = 0;
+		drawnGridSize = 0;
+	}
+
+	void DrawGridLines(const RECT & region, int gridSize, DWORD color)
+	{
+		// the same cells the targeting narrows the region down to, each one framed
+		for (int row = 0; row < gridSize; ++row)
+		{
+			for (int column = 0; column < gridSize; ++column)
+			{
+				RECT cell = logic::GridTargeting::GetCell(region, gridSize, column, row);
+				OffsetRect(&cell, -region.left, -region.top);
+				FillPixels(gridPixels, gridSurfaceWidth, cell.left, cell.top, cell.right, cell.top + 1, color);
+				FillPixels(gridPixels, gridSurfaceWidth, cell.left, cell.bottom - 1, cell.right, cell.bottom, color);
+				FillPixels(gridPixels, gridSurfaceWidth, cell.left, cell.top, cell.left + 1, cell.bottom, color);
+				FillPixels(gridPixels, gridSurfaceWidth, cell.right - 1, cell.top, cell.right, cell.bottom, color);
+			}
+		}
+	}
 
-	void RedrawOverlay()
+	void DrawTargetingGrid(HWND hWnd, const RECT & region, int gridSize)
 	{
-		POINT pt;
-		GetCursorPos(&pt);
+		const LONG width = region.right - region.left;
+		const LONG height = region.bottom - region.top;
+		if ((width <= 0) || (height <= 0)) return;
 
-		const int dx = GetSystemMetrics(SM_CXCURSOR) / 2;
-		const int dy = GetSystemMetrics(SM_CYCURSOR) / 2;
+		HDC hdc = GetDC(NULL);
+		if (!ReserveGridSurface(hdc, width, height))
+		{
+			ReleaseDC(NULL, hdc);
+			return;
+		}
 
-		SetWindowPos(overlayHwnd, HWND_TOPMOST, pt.x + dx, pt.y + dy, 0, 0, SWP_SHOWWINDOW | SWP_NOSIZE);
+		// the lines of the previous grid are tinted back, the rest of the surface has never been drawn over
+		if (drawnGridSize > 0) DrawGridLines(drawnGridRegion, drawnGridSize, kGridFillColor);
+		DrawGridLines(region, gridSize, kGridLineColor);
+		drawnGridRegion = region;
+		drawnGridSize = gridSize;
+
+		CDC dcImage;
+		dcImage.CreateCompatibleDC(hdc);
+		HBITMAP hBmpOld = dcImage.SelectBitmap(gridBitmap);
+
+		BLENDFUNCTION blendFunction;
+		blendFunction.BlendOp = AC_SRC_OVER;
+		blendFunction.BlendFlags = 0;
+		blendFunction.SourceConstantAlpha = 0xFF;
+		blendFunction.AlphaFormat = AC_SRC_ALPHA;
+
+		POINT ptDst = { region.left, region.top };
+		POINT ptSrc = { 0, 0 };
+		SIZE sz = { width, height };
+		UpdateLayeredWindow(hWnd, hdc, &ptDst, &sz, dcImage, &ptSrc, RGB(0, 0, 0), &blendFunction, ULW_ALPHA);
+		SetWindowPos(hWnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE | SWP_SHOWWINDOW);
+
+		dcImage.SelectBitmap(hBmpOld);
+		ReleaseDC(NULL, hdc);
+	}
+
+	void UpdateTargetingGrid()
+	{
+		if (!gridHwnd) return;
+
+		RECT region;
+		int gridSize;
+		{
+			std::lock_guard<std::mutex> lock(gridMutex);
+			region = requestedGridRegion;
+			gridSize = requestedGridSize;
+		}
+
+		if (gridSize > 0)
+		{
+			DrawTargetingGrid(gridHwnd, region, gridSize);
+		} else
+		{
+			ShowWindow(gridHwnd, SW_HIDE);
+			ReleaseGridSurface();
+		}
 	}
 }
 
@@ -41,11 +324,15 @@ namespace {
 //---------------------------------------------------------------------------------------------------------------------
 LRESULT CALLBACK MouseProc(int nCode, WPARAM wParam, LPARAM lParam)
 {
-	if ((nCode == HC_ACTION) && (wParam == WM_MOUSEMOVE))
+	// moves injected by the emulation are already published through MoveOverlay(), only the others need the real
+	// cursor position
+	if ((nCode == HC_ACTION) && (wParam == WM_MOUSEMOVE) &&
+	    ((reinterpret_cast<const MSLLHOOKSTRUCT *>(lParam)->flags & LLMHF_INJECTED) == 0))
 	{
-		// avoid using MSLLHOOKSTRUCT here - it provides cursor coordinates in "per-monitor-aware screen coordinates",
-		// which makes overlay position wrong on multi-monitor screens with different DPI
+		// avoid using the coordinates of MSLLHOOKSTRUCT here - it provides cursor coordinates in "per-monitor-aware
+		// screen coordinates", which makes overlay position wrong on multi-monitor screens with different DPI
 		// (as long as NeatMouse declares to be "DPI unaware")
+		reconcileRequested.store(true);
 		PostRedrawOverlay();
 	}
 	return CallNextHookEx(mouseHook, nCode, wParam, lParam);
@@ -77,6 +364,42 @@ void DrawOverlay(HWND hwndSplash, HBITMAP hbmpSplash)
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+void ShowOverlay(HWND hWnd)
+{
+	if (overlayVisible) return;
+
+	// the hook is only needed while the overlay follows the cursor
+	mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseProc, overlayInstance, 0);
+	if (!mouseHook) return;
+
+	overlayVisible = true;
+	UpdateCursorMetrics();
+	lastRedrawTime = std::chrono::steady_clock::time_point();
+	lastPosition.x = lastPosition.y = LONG_MIN;
+	reconcileRequested.store(true);
+	RedrawOverlay(hWnd);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void HideOverlay(HWND hWnd)
+{
+	if (!overlayVisible) return;
+
+	overlayVisible = false;
+	UnhookWindowsHookEx(mouseHook);
+	mouseHook = NULL;
+	if (redrawTimerSet)
+	{
+		KillTimer(hWnd, REDRAW_TIMER_ID);
+		redrawTimerSet = false;
+	}
+	KillTimer(hWnd, RECONCILE_TIMER_ID);
+	ShowWindow(hWnd, SW_HIDE);
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -85,22 +408,52 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 	case WM_COMMAND:
 		return DefWindowProc(hWnd, message, wParam, lParam);
 	case WM_CREATE:
-		mouseHook = SetWindowsHookEx(WH_MOUSE_LL, MouseProc, overlayInstance, 0);
-		if (!mouseHook)
-		{
-			PostMessage(hWnd, WM_DESTROY, 0, 0);
-			break;
-		}
 		DrawOverlay(hWnd, overlayBitmap);
 		break;
 	case WM_CLOSE:
-		UnhookWindowsHookEx(mouseHook);
-		mouseHook = NULL;
+		HideOverlay(hWnd);
+		if (gridHwnd)
+		{
+			DestroyWindow(gridHwnd);
+			gridHwnd = NULL;
+		}
+		ReleaseGridSurface();
+		DestroyWindow(hWnd);
+		break;
+	case WM_DESTROY:
 		PostQuitMessage(0);
 		break;
+	case WM_NEATMOUSE_OVERLAY_SHOW:
+		ShowOverlay(hWnd);
+		break;
+	case WM_NEATMOUSE_OVERLAY_HIDE:
+		HideOverlay(hWnd);
+		break;
 	case WM_NEATMOUSE_OVERLAY_REDRAW:
-		RedrawOverlay();
+		RedrawOverlay(hWnd);
+		break;
+	case WM_NEATMOUSE_GRID_UPDATE:
+		UpdateTargetingGrid();
+		break;
+	case WM_TIMER:
+		if (wParam == REDRAW_TIMER_ID)
+		{
+			RedrawOverlay(hWnd);
+		} else
+		if (wParam == RECONCILE_TIMER_ID)
+		{
+			KillTimer(hWnd, RECONCILE_TIMER_ID);
+			reconcileRequested.store(true);
+			RedrawOverlay(hWnd);
+		}
 		break;
+	case WM_SETTINGCHANGE:
+	case WM_DISPLAYCHANGE:
+		UpdateCursorMetrics();
+		lastPosition.x = lastPosition.y = LONG_MIN;
+		reconcileRequested.store(true);
+		PostRedrawOverlay();
+		return DefWindowProc(hWnd, message, wParam, lParam);
 	default:
 		return DefWindowProc(hWnd, message, wParam, lParam);
 	}
@@ -108,6 +461,69 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+unsigned int WINAPI ThreadProc(void * readyEvent)
+{
+	// the window is created hidden and lives as long as the process; it is shown and hidden by messages
+	overlayHwnd = CreateWindowEx(
+		WS_EX_NOACTIVATE | WS_EX_LAYERED,
+		OVERLAY_WINDOW_NAME,
+		NULL,
+		WS_POPUP,
+		0,
+		0,
+		16,
+		16,
+		NULL,
+		NULL,
+		overlayInstance,
+		NULL);
+	if (overlayHwnd)
+	{
+		// the grid lets the mouse input through to the windows under it
+		gridHwnd = CreateWindowEx(
+			WS_EX_NOACTIVATE | WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW,
+			GRID_WINDOW_NAME,
+			NULL,
+			WS_POPUP,
+			0,
+			0,
+			1,
+			1,
+			NULL,
+			NULL,
+			overlayInstance,
+			NULL);
+	}
+	SetEvent(static_cast<HANDLE>(readyEvent));
+	if (!overlayHwnd)
+	{
+		return 1;
+	}
+
+	MSG msg;
+	while (GetMessage(&msg, NULL, 0, 0))
+	{
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+
+	return 0;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void StartOverlayThread()
+{
+	HANDLE readyEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!readyEvent) return;
+
+	threadHandle = (HANDLE)_beginthreadex(0, 0, ThreadProc, readyEvent, 0, 0);
+	if (threadHandle) WaitForSingleObject(readyEvent, INFINITE);
+	CloseHandle(readyEvent);
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 void InitOverlay(HINSTANCE hinst)
 {
@@ -131,81 +547,127 @@ void InitOverlay(HINSTANCE hinst)
 
 	RegisterClassEx(&wcex);
 
+	// the grid window is driven by the overlay window, which draws it
+	wcex.lpfnWndProc = DefWindowProc;
+	wcex.lpszClassName = GRID_WINDOW_NAME;
+
+	RegisterClassEx(&wcex);
+
 	overlayBitmap = neatcommon::ui::AtlLoadGdiplusImage(IDB_PNG_NEATMOUSE, _T("PNG"));
+
+	// the overlay and the grid are requested from the keyboard hook, which must never wait for the thread to start
+	StartOverlayThread();
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
 void UninitOverlay()
 {
-	DisableIconOverlay();
+	const HWND hwnd = overlayHwnd.load();
+	if (hwnd) PostMessage(hwnd, WM_CLOSE, 0, 0);
+	if (threadHandle)
+	{
+		WaitForSingleObject(threadHandle, INFINITE);
+		CloseHandle(threadHandle);
+		threadHandle = NULL;
+	}
+	overlayHwnd = NULL;
+
 	if (overlayBitmap) DeleteObject(overlayBitmap);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-unsigned int WINAPI ThreadProc(void *)
+void EnableIconOverlay()
 {
-	const int dx = GetSystemMetrics(SM_CXCURSOR) / 2;
-	const int dy = GetSystemMetrics(SM_CYCURSOR) / 2;
-	POINT p;
-	GetCursorPos(&p);
-	overlayHwnd = CreateWindowEx(
-		WS_EX_NOACTIVATE | WS_EX_LAYERED,
-		OVERLAY_WINDOW_NAME,
-		NULL,
-		WS_POPUP | WS_VISIBLE,
-		p.x + dx,
-		p.y + dy,
-		16,
-		16,
-		NULL,
-		NULL,
-		overlayInstance,
-		NULL);
-	if (!overlayHwnd)
+	const HWND hwnd = overlayHwnd.load();
+	if (hwnd) PostMessage(hwnd, WM_NEATMOUSE_OVERLAY_SHOW, 0, 0);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void DisableIconOverlay()
+{
+	const OverlayRedrawStats stats = GetOverlayRedrawStats();
+	ATLTRACE(_T("Overlay redraws: %lu requested, %lu posted, %lu serviced\n"), stats.requested, stats.posted, stats.serviced);
+
+	const HWND hwnd = overlayHwnd.load();
+	if (hwnd) PostMessage(hwnd, WM_NEATMOUSE_OVERLAY_HIDE, 0, 0);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void PostRedrawOverlay()
+{
+	++redrawsRequested;
+	const HWND hwnd = overlayHwnd.load();
+	if (hwnd && !redrawPending.exchange(true))
 	{
-		return 1;
+		++redrawsPosted;
+		PostMessage(hwnd, WM_NEATMOUSE_OVERLAY_REDRAW, 0, 0);
 	}
+}
 
-	ShowWindow(overlayHwnd, SW_SHOWNORMAL);
-	UpdateWindow(overlayHwnd);
 
-	SetWindowPos(overlayHwnd, HWND_TOPMOST, p.x + dx, p.y + dy, 0, 0, SWP_SHOWWINDOW | SWP_NOSIZE);
-	MSG msg;
-	while (GetMessage(&msg, NULL, 0, 0))
+//---------------------------------------------------------------------------------------------------------------------
+void MoveOverlay(LONG dx, LONG dy)
+{
+	WritePosition([dx, dy]()
 	{
-		TranslateMessage(&msg);
-		DispatchMessage(&msg);
-	}
+		predictedX.store(predictedX.load(std::memory_order_relaxed) + dx, std::memory_order_relaxed);
+		predictedY.store(predictedY.load(std::memory_order_relaxed) + dy, std::memory_order_relaxed);
+	});
+	PostRedrawOverlay();
+}
 
-	return 0;
+
+//---------------------------------------------------------------------------------------------------------------------
+void PlaceOverlay(LONG x, LONG y)
+{
+	WritePosition([x, y]()
+	{
+		predictedX.store(x, std::memory_order_relaxed);
+		predictedY.store(y, std::memory_order_relaxed);
+	});
+	PostRedrawOverlay();
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void EnableIconOverlay()
+void ShowTargetingGrid(const RECT & region, int gridSize)
 {
-	if (overlayHwnd || threadHandle) DisableIconOverlay();
-	threadHandle = (HANDLE)_beginthreadex(0, 0, ThreadProc, 0, 0, 0);
+	{
+		std::lock_guard<std::mutex> lock(gridMutex);
+		requestedGridRegion = region;
+		requestedGridSize = gridSize;
+	}
+
+	const HWND hwnd = overlayHwnd.load();
+	if (hwnd) PostMessage(hwnd, WM_NEATMOUSE_GRID_UPDATE, 0, 0);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void DisableIconOverlay()
+void HideTargetingGrid()
 {
-	SendMessage(overlayHwnd, WM_CLOSE, 0, 0);
-	CloseHandle(threadHandle);
+	{
+		std::lock_guard<std::mutex> lock(gridMutex);
+		requestedGridSize = 0;
+	}
 
-	overlayHwnd = NULL;
-	threadHandle = 0;
+	const HWND hwnd = overlayHwnd.load();
+	if (hwnd) PostMessage(hwnd, WM_NEATMOUSE_GRID_UPDATE, 0, 0);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void PostRedrawOverlay()
+OverlayRedrawStats GetOverlayRedrawStats()
 {
-	PostMessage(overlayHwnd, WM_NEATMOUSE_OVERLAY_REDRAW, 0, 0);
+	OverlayRedrawStats stats;
+	stats.requested = redrawsRequested.load();
+	stats.posted = redrawsPosted.load();
+	stats.serviced = redrawsServiced.load();
+	return stats;
 }
 
 } // namespace neatmouse
\ No newline at end of file
@@ -17,4 +17,34 @@ void EnableIconOverlay();
 void DisableIconOverlay();
 void PostRedrawOverlay();
 
+/**
+ * Move the overlay by the delta the emulation has just injected, without querying the cursor position
+ */
+void MoveOverlay(LONG dx, LONG dy);
+
+/**
+ * Move the overlay to the point the emulation has just moved the cursor to
+ */
+void PlaceOverlay(LONG x, LONG y);
+
+/**
+ * Show the grid of the targeting mode laid over the region (in screen coordinates), or hide it. The grid is shown
+ * whether the cursor overlay is enabled or not.
+ */
+void ShowTargetingGrid(const RECT & region, int gridSize);
+void HideTargetingGrid();
+
+/**
+ * Counters of the overlay redraws: requests coming from the mouse hook and the emulation, messages actually posted to
+ * the overlay window after coalescing, and redraws done after frame pacing.
+ */
+struct OverlayRedrawStats
+{
+	unsigned long requested;
+	unsigned long posted;
+	unsigned long serviced;
+};
+
+OverlayRedrawStats GetOverlayRedrawStats();
+
 } // namespace neatmouse
\ No newline at end of file
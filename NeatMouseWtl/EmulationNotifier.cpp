@@ -56,9 +56,30 @@ void EmulationNotifier::TriggerOverlay(bool enabled)
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void EmulationNotifier::UpdateOverlay()
+void EmulationNotifier::MoveOverlay(LONG dx, LONG dy)
 {
-	PostRedrawOverlay();
+	neatmouse::MoveOverlay(dx, dy);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void EmulationNotifier::PlaceOverlay(LONG x, LONG y)
+{
+	neatmouse::PlaceOverlay(x, y);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void EmulationNotifier::ShowTargetingGrid(const RECT & region, int gridSize)
+{
+	neatmouse::ShowTargetingGrid(region, gridSize);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void EmulationNotifier::HideTargetingGrid()
+{
+	neatmouse::HideTargetingGrid();
 }
 
 
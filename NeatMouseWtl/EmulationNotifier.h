@@ -18,7 +18,10 @@ struct EmulationNotifier : logic::IEmulationNotifier
 	explicit EmulationNotifier(HWND mainWindow);
 	void Notify(bool enabled) override;
 	void TriggerOverlay(bool enabled) override;
-	void UpdateOverlay() override;
+	void MoveOverlay(LONG dx, LONG dy) override;
+	void PlaceOverlay(LONG x, LONG y) override;
+	void ShowTargetingGrid(const RECT & region, int gridSize) override;
+	void HideTargetingGrid() override;
 
 private:
 	HWND hwndMainWindow = NULL;
@@ -22,6 +22,11 @@
 
 namespace neatmouse {
 
+namespace {
+	// delay after the last change in the settings folder before the presets are re-read
+	constexpr unsigned long kSettingsReloadDelayMs = 500;
+}
+
 
 //---------------------------------------------------------------------------------------------------------------------
 BOOL
@@ -257,6 +262,17 @@ CMainFrame::OnCreate(LPCREATESTRUCT /*lpcs*/)
 	m_view.disableAdvancedMode();
 	resizeByContent();
 
+	// pick up the presets which are added or modified in the settings folder while NeatMouse is running
+	settingsWatcher.Start(logic::MainSingleton::Instance().GetOptionsHolder().GetOptionsFolder(), kSettingsReloadDelayMs,
+		[this](const std::vector<std::wstring> & filePaths)
+		{
+			{
+				std::lock_guard<std::mutex> lock(changedSettingsMutex);
+				changedSettingsFiles.insert(changedSettingsFiles.end(), filePaths.begin(), filePaths.end());
+			}
+			PostMessage(NEAT_SETTINGS_CHANGED);
+		});
+
 	return 0;
 }
 
@@ -329,10 +345,34 @@ CMainFrame::OnTrayBtnClick(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM lParam, BOOL
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+LRESULT
+CMainFrame::OnSettingsChanged(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& bHandled)
+{
+	std::vector<std::wstring> filePaths;
+	{
+		std::lock_guard<std::mutex> lock(changedSettingsMutex);
+		filePaths.swap(changedSettingsFiles);
+	}
+
+	if (logic::MainSingleton::Instance().ReloadSettingsFiles(filePaths))
+	{
+		tb.FillSettings();
+		cbPresetsSelectionIndex = tb.comboPresets.GetCurSel();
+		m_view.PopulateControls();
+	}
+
+	bHandled = TRUE;
+	return 0;
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 LRESULT
 CMainFrame::OnDestroy(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& bHandled)
 {
+	settingsWatcher.Stop();
+
 	// unregister message filtering and idle updates
 	CMessageLoop* pLoop = _Module.GetMessageLoop();
 	ATLASSERT(pLoop != NULL);
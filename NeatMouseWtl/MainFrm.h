@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <mutex>
 #include "NeatMouseWtlView.h"
+#include "neatcommon/system/DirectoryWatcher.h"
 #include "neatcommon/ui/CustomizedControls.h"
 
 namespace neatmouse {
@@ -26,6 +28,7 @@ class CMainFrame : public CFrameWindowImpl<CMainFrame>,
 
 		MESSAGE_HANDLER(WM_DESTROY, OnDestroy)
 		MESSAGE_HANDLER(NEAT_TRAY_CALLBACK, OnTrayBtnClick)
+		MESSAGE_HANDLER(NEAT_SETTINGS_CHANGED, OnSettingsChanged)
 
 		COMMAND_HANDLER_EX(ID_TOOLBAR_ADDPRESET, BN_CLICKED, OnBnClickedButtonPresetAdd)
 		COMMAND_HANDLER_EX(ID_TOOLBAR_SAVEPRESET, BN_CLICKED, OnBnClickedButtonPresetSave)
@@ -75,6 +78,7 @@ private:
 	LRESULT OnAppAbout(UINT /*wNotifyCode*/, int /*wID*/, HWND /*hWndCtl*/);
 
 	LRESULT OnTrayBtnClick(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM lParam, BOOL& bHandled);
+	LRESULT OnSettingsChanged(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& bHandled);
 
 	LRESULT OnDestroy(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/, BOOL& bHandled);
 	LRESULT OnFileExit(WORD /*wNotifyCode*/, WORD /*wID*/, HWND /*hWndCtl*/, BOOL& /*bHandled*/);
@@ -91,6 +95,10 @@ private:
 	CNeatMouseWtlView m_view;
 	CNeatToolbar tb;
 
+	neatcommon::system::DirectoryWatcher settingsWatcher;
+	std::mutex changedSettingsMutex;
+	std::vector<std::wstring> changedSettingsFiles;
+
 	int cbPresetsSelectionIndex = 0;
 	bool isVisible = true;
 };
@@ -23,7 +23,10 @@
 #include "CursorOverlay.h"
 #include "EmulationNotifier.h"
 
+#include "logic/AllocationGuard.h"
+#include "logic/GridTargeting.h"
 #include "logic/HookThread.h"
+#include "logic/SnapshotPipeServer.h"
 #include "logic/MainSingleton.h"
 
 
@@ -63,6 +66,9 @@ int Run(LPTSTR /*lpstrCmdLine*/ = NULL, int nCmdShow = SW_SHOWDEFAULT)
 		break;
 	}
 
+	// decode the icons while the main window is being created
+	neatmouse::logic::MainSingleton::Instance().GetImageManager().Preload();
+
 	neatmouse::CMainFrame wndMain;
 	RECT rect{ 0, 0, 640, 480 };
 	if (wndMain.CreateEx(0, rect, WS_OVERLAPPEDWINDOW & ~WS_MAXIMIZEBOX & ~WS_SIZEBOX ) == NULL)
@@ -100,7 +106,16 @@ int Run(LPTSTR /*lpstrCmdLine*/ = NULL, int nCmdShow = SW_SHOWDEFAULT)
 	}
 
 	Shell_NotifyIcon(NIM_ADD, &nd);
-	neatmouse::logic::HookThread::Initialize(_Module.m_hInst);
+	neatmouse::logic::HookThread::Initialize(_Module.m_hInst, neatmouse::logic::MainSingleton::Instance().GetEngineContext());
+
+	neatmouse::logic::EngineContext & engineContext = neatmouse::logic::MainSingleton::Instance().GetEngineContext();
+	neatmouse::logic::InstallFlightRecorderCrashDump(engineContext.GetFlightRecorder());
+
+	// local diagnostics: the metrics in the Prometheus text format, and the dump of the last keyboard events
+	neatmouse::logic::SnapshotPipeServer metricsServer;
+	metricsServer.Start(L"NeatMouse.metrics", [&engineContext]() { return engineContext.GetMetricsText(); });
+	neatmouse::logic::SnapshotPipeServer flightRecorderServer;
+	flightRecorderServer.Start(L"NeatMouse.flightrecorder", [&engineContext]() { return engineContext.GetFlightRecorder().GetDump(); });
 
 	int nRet = theLoop.Run();
 
@@ -119,6 +134,11 @@ int WINAPI wWinMain(
 	_In_ LPWSTR lpstrCmdLine,
 	_In_ int nCmdShow)
 {
+	neatmouse::logic::InstallAllocationGuard();
+
+	// the checks are pure computation, and compiled out of release builds along with the assertion
+	ATLASSERT(neatmouse::logic::GridTargeting::SelfCheck());
+
 	HRESULT hRes = ::CoInitialize(NULL);
 	ATLASSERT(SUCCEEDED(hRes));
 
@@ -134,6 +154,8 @@ int WINAPI wWinMain(
 	ATLASSERT(SUCCEEDED(hRes));
 
 	int nRet = Run(lpstrCmdLine, nCmdShow);
+	// the preloading thread uses GDI+, which is shut down along with gdiplusInit
+	neatmouse::logic::MainSingleton::Instance().GetImageManager().StopPreload();
 
 	_Module.Term();
 	::CoUninitialize();
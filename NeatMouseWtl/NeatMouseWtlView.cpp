@@ -42,7 +42,7 @@ CNeatMouseWtlView::GetHotkeyName(UINT mods, UINT vk)
 	if (mods & MOD_CONTROL) res += L"Ctrl + ";
 	if (mods & MOD_ALT) res += L"Alt + ";
 	if (mods & MOD_SHIFT) res += L"Shift + ";
-	res += logic::KeyboardUtils::GetKeyName(vk, 0).c_str();
+	res += logic::KeyboardUtils::GetKeyName(vk).c_str();
 
 	return res;
 }
@@ -265,6 +265,19 @@ CNeatMouseWtlView::OnPaint(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lParam*/,
 
 	EndPaint(&ps);
 
+	if (!m_firstPaintTraced)
+	{
+		m_firstPaintTraced = true;
+		FILETIME creationTime, exitTime, kernelTime, userTime, now;
+		if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+		{
+			GetSystemTimeAsFileTime(&now);
+			const ULONGLONG start = (static_cast<ULONGLONG>(creationTime.dwHighDateTime) << 32) | creationTime.dwLowDateTime;
+			const ULONGLONG end = (static_cast<ULONGLONG>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
+			ATLTRACE(_T("Time to first paint: %I64u ms\n"), (end - start) / 10000);
+		}
+	}
+
 	bHandled = FALSE;
 	return 1;
 }
@@ -576,22 +589,22 @@ CNeatMouseWtlView::PopulateControls()
 	s = std::to_wstring(mouseParams.adelta);
 	GetDlgItem(IDC_EDIT_ALT_SPEED).SetWindowText(s.c_str());
 
-	GetDlgItem(IDC_EDIT_BTN_LEFT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKPressLB, 0).c_str());
-	GetDlgItem(IDC_EDIT_BTN_RIGHT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKPressRB, 0).c_str());
-	GetDlgItem(IDC_EDIT_BTN_MIDDLE).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKPressMB, 0).c_str());
+	GetDlgItem(IDC_EDIT_BTN_LEFT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKPressLB).c_str());
+	GetDlgItem(IDC_EDIT_BTN_RIGHT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKPressRB).c_str());
+	GetDlgItem(IDC_EDIT_BTN_MIDDLE).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKPressMB).c_str());
 
-	GetDlgItem(IDC_EDIT_UP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveUp, 0).c_str());
-	GetDlgItem(IDC_EDIT_DOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveDown, 0).c_str());
-	GetDlgItem(IDC_EDIT_LEFT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveLeft, 0).c_str());
-	GetDlgItem(IDC_EDIT_RIGHT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveRight, 0).c_str());
+	GetDlgItem(IDC_EDIT_UP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveUp).c_str());
+	GetDlgItem(IDC_EDIT_DOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveDown).c_str());
+	GetDlgItem(IDC_EDIT_LEFT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveLeft).c_str());
+	GetDlgItem(IDC_EDIT_RIGHT).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveRight).c_str());
 
-	GetDlgItem(IDC_EDIT_LEFTUP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveLeftUp, 0).c_str());
-	GetDlgItem(IDC_EDIT_RIGHTUP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveRightUp, 0).c_str());
-	GetDlgItem(IDC_EDIT_LEFTDOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveLeftDown, 0).c_str());
-	GetDlgItem(IDC_EDIT_RIGHTDOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveRightDown, 0).c_str());
+	GetDlgItem(IDC_EDIT_LEFTUP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveLeftUp).c_str());
+	GetDlgItem(IDC_EDIT_RIGHTUP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveRightUp).c_str());
+	GetDlgItem(IDC_EDIT_LEFTDOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveLeftDown).c_str());
+	GetDlgItem(IDC_EDIT_RIGHTDOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKMoveRightDown).c_str());
 
-	GetDlgItem(IDC_EDIT_SCROLL_UP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKWheelUp, 0).c_str());
-	GetDlgItem(IDC_EDIT_SCROLL_DOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKWheelDown, 0).c_str());
+	GetDlgItem(IDC_EDIT_SCROLL_UP).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKWheelUp).c_str());
+	GetDlgItem(IDC_EDIT_SCROLL_DOWN).SetWindowText(logic::KeyboardUtils::GetKeyName(mouseParams.VKWheelDown).c_str());
 
 	GetDlgItem(IDC_EDIT_HOTKEY).SetWindowText(GetHotkeyName(mouseParams.modHotkey, mouseParams.VKHotkey));
 
@@ -690,9 +703,9 @@ CNeatMouseWtlView::FillModifierCombobox(
 	{
 		if ( skip.find(key) == skip.end() )
 		{
-			std::wstring itemLabel = logic::KeyboardUtils::GetKeyName(key, 0);
-			if (itemLabel.empty()) itemLabel = _("main.combo-item-none");
-			comboBox.SetItemData( comboBox.AddString(itemLabel.c_str()), key );
+			const std::wstring & keyName = logic::KeyboardUtils::GetKeyName(key);
+			const wchar_t * itemLabel = keyName.empty() ? _("main.combo-item-none") : keyName.c_str();
+			comboBox.SetItemData( comboBox.AddString(itemLabel), key );
 			if (key == valueToSet) neededValueFound = true;
 		}
 	}
@@ -981,9 +994,9 @@ CNeatMouseWtlView::OnInitDialog(UINT /*uMsg*/, WPARAM /*wParam*/, LPARAM /*lPara
 
 	CComboBox cbEnabler;
 	cbEnabler.Attach(GetDlgItem(IDC_COMBO_ACTIVATION));
-	cbEnabler.SetItemData(cbEnabler.AddString(logic::KeyboardUtils::GetKeyName(VK_NUMLOCK, 0).c_str()), VK_NUMLOCK);
-	cbEnabler.SetItemData(cbEnabler.AddString(logic::KeyboardUtils::GetKeyName(VK_CAPITAL, 0).c_str()), VK_CAPITAL);
-	cbEnabler.SetItemData(cbEnabler.AddString(logic::KeyboardUtils::GetKeyName(VK_SCROLL, 0).c_str()), VK_SCROLL);
+	cbEnabler.SetItemData(cbEnabler.AddString(logic::KeyboardUtils::GetKeyName(VK_NUMLOCK).c_str()), VK_NUMLOCK);
+	cbEnabler.SetItemData(cbEnabler.AddString(logic::KeyboardUtils::GetKeyName(VK_CAPITAL).c_str()), VK_CAPITAL);
+	cbEnabler.SetItemData(cbEnabler.AddString(logic::KeyboardUtils::GetKeyName(VK_SCROLL).c_str()), VK_SCROLL);
 	cbEnabler.SetItemData(cbEnabler.AddString(L"Hotkey"), 0);
 	cbEnabler.SetCurSel(0);
 	cbEnabler.Detach();
@@ -85,6 +85,7 @@ protected:
 	std::array<neatcommon::ui::CButtonST, 13> m_btnDel{};
 	neatcommon::ui::CButtonST m_btnDelHotkey;
 	int m_checkBoxPadding = 0;
+	bool m_firstPaintTraced = false;
 };
 
 } // namespace neatmouse
\ No newline at end of file
@@ -235,7 +235,7 @@ CNeatToolbar::DeleteCurrentSettings()
 void
 CNeatToolbar::FillSettings()
 {
-	comboPresets.Clear();
+	comboPresets.ResetContent();
 	int cbPresetsSelectionIndex = 0;
 
 	logic::COptionsHolder & optionsHolder = logic::MainSingleton::Instance().GetOptionsHolder();
@@ -0,0 +1,55 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Install the CRT allocation hook the scopes below rely on; does nothing in release builds
+ */
+void InstallAllocationGuard();
+
+
+/**
+ * Debug-build check that a section of code doesn't allocate: the heap allocations made on the calling thread while
+ * the object is alive are counted, and the destructor asserts there were none
+ */
+class NoAllocationScope
+{
+public:
+	NoAllocationScope();
+	~NoAllocationScope();
+
+	NoAllocationScope(const NoAllocationScope &) = delete;
+	NoAllocationScope & operator=(const NoAllocationScope &) = delete;
+
+private:
+	unsigned long m_allocationsBefore;
+};
+
+
+/**
+ * Exempts a rare path, such as notifying the UI, from the check of the enclosing NoAllocationScope
+ */
+class AllowAllocationScope
+{
+public:
+	AllowAllocationScope();
+	~AllowAllocationScope();
+
+	AllowAllocationScope(const AllowAllocationScope &) = delete;
+	AllowAllocationScope & operator=(const AllowAllocationScope &) = delete;
+
+private:
+	int m_savedDepth;
+};
+
+}}
\ No newline at end of file
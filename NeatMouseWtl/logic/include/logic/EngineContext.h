@@ -0,0 +1,92 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include "logic/EngineCounters.h"
+#include "logic/EventProcessingStats.h"
+#include "logic/FlightRecorder.h"
+#include "logic/IEmulationNotifier.h"
+#include "logic/IMouseOutput.h"
+#include "logic/MotionClock.h"
+#include "logic/ThreadScheduling.h"
+#include "logic/MouseActioner.h"
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Everything an emulation engine works with: the actioner with its parameters snapshot, the destination of the
+ * generated mouse events, the clock timing the motion and the notifier of the UI. Nothing in the engine refers to a
+ * global instance, so several contexts may run side by side in the same process.
+ */
+class EngineContext
+{
+public:
+	EngineContext(const IMouseOutput::Ptr & output, const IMotionClock::Ptr & clock);
+	EngineContext(const EngineContext &) = delete;
+	EngineContext & operator=(const EngineContext &) = delete;
+
+	MouseActioner & GetMouseActioner() { return mouseActioner; }
+	IMouseOutput & GetMouseOutput() { return *mouseOutput; }
+	IMotionClock & GetMotionClock() { return *motionClock; }
+	EventProcessingHistogram & GetEventProcessingHistogram() { return eventProcessingHistogram; }
+	EngineCounters & GetCounters() { return counters; }
+	FlightRecorder & GetFlightRecorder() { return flightRecorder; }
+
+	void SetEmulationNotifier(const IEmulationNotifier::Ptr & notifier);
+
+	/**
+	 * Set the scheduling of the threads of the engine. The hook thread takes it when it starts, the motion threads
+	 * take it from their next move.
+	 */
+	void SetThreadScheduling(const ThreadSchedulingOptions & options);
+	ThreadSchedulingOptions GetThreadScheduling();
+
+	/**
+	 * Move the cursor through the output and let the overlay follow it
+	 */
+	void MoveCursor(LONG dx, LONG dy);
+
+	/**
+	 * Move the cursor to the given point of the screen with a single absolute move, and the overlay with it
+	 */
+	void MoveCursorTo(LONG x, LONG y);
+
+	/**
+	 * Show the grid of the targeting mode laid over the region, or hide it
+	 */
+	void ShowTargetingGrid(const RECT & region, int gridSize);
+	void HideTargetingGrid();
+
+	void NotifyEnabling(bool enabled);
+	void TriggerOverlay();
+
+	/**
+	 * Snapshot of the counters and the event processing times in the Prometheus text format; reads atomics only,
+	 * so it never waits for the hook thread
+	 */
+	std::string GetMetricsText();
+
+private:
+	// declared first: the output counts the events it sends
+	EngineCounters counters;
+	IMouseOutput::Ptr mouseOutput;
+	IMotionClock::Ptr motionClock;
+	IEmulationNotifier::Ptr emulationNotifier;
+	std::mutex threadSchedulingMutex;
+	ThreadSchedulingOptions threadScheduling;
+	EventProcessingHistogram eventProcessingHistogram;
+	FlightRecorder flightRecorder;
+
+	// declared last: the actioner refers to the context and releases the held mouse buttons when destroyed
+	MouseActioner mouseActioner;
+};
+
+}}
\ No newline at end of file
@@ -0,0 +1,50 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <atomic>
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Counters of the activity of an engine. Every counter is written by the thread doing the work with relaxed atomic
+ * operations, so that reading them from another thread never holds the hook thread back.
+ */
+struct EngineCounters
+{
+	using Counter_t = std::atomic<unsigned long>;
+
+	// keyboard events received by the hook, and how many of them were blocked or passed on to the system
+	Counter_t eventsSeen{ 0 };
+	Counter_t eventsBlocked{ 0 };
+	Counter_t eventsPassed{ 0 };
+
+	// mouse events sent to the output: moves, button presses and releases, wheel
+	Counter_t mouseInjections{ 0 };
+	Counter_t rampStarts{ 0 };
+	Counter_t overlayUpdates{ 0 };
+
+	// resets which dropped some state: a key, button, modifier or the targeting mode held when the reset came
+	Counter_t resets{ 0 };
+	Counter_t paramSwaps{ 0 };
+
+	std::atomic<bool> hookInstalled{ false };
+
+	// hooks installed anew after the system had likely removed them for answering too late
+	Counter_t hookReinstalls{ 0 };
+
+	// GetTickCount() when the hook received its last event
+	Counter_t lastEventTick{ 0 };
+
+	static void Increment(Counter_t & counter) { counter.fetch_add(1, std::memory_order_relaxed); }
+};
+
+}}
\ No newline at end of file
@@ -0,0 +1,51 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Time the engine took to process the keyboard events
+ */
+struct EventProcessingStats
+{
+	unsigned long events;
+	double meanUs;
+	double p99Us;
+	double maxUs;
+};
+
+
+/**
+ * Histogram of the processing times of the keyboard events. Recorded by the hook thread without locking or
+ * allocating; the statistics may be read from any thread.
+ */
+class EventProcessingHistogram
+{
+public:
+	void Record(std::chrono::steady_clock::duration duration);
+	EventProcessingStats GetStats() const;
+
+private:
+	// bucket i gathers the durations from 2^i to 2^(i+1) nanoseconds
+	static constexpr std::size_t kBucketCount = 32;
+
+	std::array<std::atomic<unsigned long>, kBucketCount> m_buckets{};
+	std::atomic<unsigned long> m_events{ 0 };
+	std::atomic<long long> m_sumNs{ 0 };
+	std::atomic<long long> m_maxNs{ 0 };
+};
+
+}}
\ No newline at end of file
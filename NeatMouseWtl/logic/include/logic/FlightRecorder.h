@@ -0,0 +1,101 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * What the engine decided about one keyboard event. The key, its flags and the time are enough to rebuild the
+ * KeyEvent and replay the sequence through MouseActioner. A key the profile doesn't bind is recorded with a vk and
+ * scan code of 0, and replays as any unbound key.
+ */
+struct FlightRecord
+{
+	enum Flag_t : std::uint8_t
+	{
+		kKeyUp    = 0x01,
+		kExtended = 0x02,
+		kInjected = 0x04,
+		kBlocked  = 0x08
+	};
+
+	// time of the event as reported by the hook, in milliseconds (GetTickCount clock)
+	std::uint32_t time;
+	std::uint16_t scanCode;
+	std::uint8_t vk;
+	std::uint8_t flags;
+
+	// MouseActioner::getStateMask() before and after the event was processed
+	std::uint16_t stateBefore;
+	std::uint16_t stateAfter;
+
+	// mouse events sent to the output while the event was processed; a ramp-up step of the motion thread happening
+	// at the same moment is counted too
+	std::uint16_t injections;
+
+	// processing time, in microseconds, saturated
+	std::uint16_t processingUs;
+};
+
+static_assert(sizeof(FlightRecord) == 16, "FlightRecord is written to the dumps as is");
+
+
+/**
+ * Ring buffer of the last keyboard events which went through the emulation: every event of the keys bound by the
+ * profile, and the events of the other keys which changed the state of the emulation, without their key, so that
+ * what is typed can't be read back. Recording is a few stores without locks or allocations; it must be done by a
+ * single thread, the hook thread. The dump may be taken from any thread.
+ *
+ * Dump format (little endian): the "NMFR" signature, a 32-bit version (1), a 32-bit record count, and the records
+ * from the oldest to the newest.
+ */
+class FlightRecorder
+{
+public:
+	static constexpr std::size_t kCapacity = 4096;
+
+	void Record(const FlightRecord & record);
+
+	/**
+	 * Copy the recorded events, from the oldest to the newest; the ones being overwritten meanwhile are left out
+	 *
+	 * @param oRecords  Buffer receiving the records, kCapacity long
+	 *
+	 * @return  Number of records copied
+	 */
+	std::size_t CopyRecords(FlightRecord * oRecords) const;
+
+	std::string GetDump() const;
+
+private:
+	std::array<FlightRecord, kCapacity> m_records{};
+
+	// number of records written so far; a record is published once it's incremented
+	std::atomic<std::uint32_t> m_written{ 0 };
+};
+
+
+#ifdef _WIN32
+
+/**
+ * Write the dump of the recorder to %TEMP%\NeatMouse.nmfr if the process crashes. The recorder must live until the
+ * end of the process.
+ */
+void InstallFlightRecorderCrashDump(const FlightRecorder & recorder);
+
+#endif
+
+}}
\ No newline at end of file
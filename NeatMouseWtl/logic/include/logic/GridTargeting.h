@@ -0,0 +1,85 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Region math of the grid targeting mode: the region, initially the whole monitor, is split into a grid of cells,
+ * and every choice of a cell narrows the region down to it, until the target is reached with a single move. Pure
+ * computation, independent of the keyboard and of the screen.
+ */
+class GridTargeting
+{
+public:
+	// the cells are chosen with the movement keys, which give at most three choices along each axis
+	static constexpr int kMinGridSize = 2;
+	static constexpr int kMaxGridSize = 3;
+
+	/**
+	 * Start the targeting over the given region
+	 *
+	 * @param bounds    Region to start from, in screen coordinates (right and bottom excluded)
+	 * @param gridSize  Number of the columns and of the rows of the grid, clamped to [kMinGridSize, kMaxGridSize]
+	 */
+	void Start(const RECT & bounds, int gridSize);
+	void Stop();
+	bool IsActive() const { return m_isActive; }
+
+	/**
+	 * Narrow the region down to one of its cells
+	 *
+	 * @param horizontal  -1 for the leftmost column, 1 for the rightmost one, 0 for the middle one
+	 * @param vertical    -1 for the topmost row, 1 for the bottommost one, 0 for the middle one
+	 *
+	 * @return  False if the targeting is off or the grid has no such cell (the middle one of an even grid)
+	 */
+	bool Narrow(int horizontal, int vertical);
+
+	/**
+	 * Check whether the region is still larger than a single pixel
+	 */
+	bool CanNarrow() const;
+
+	RECT GetRegion() const { return m_region; }
+	int GetGridSize() const { return m_gridSize; }
+
+	/**
+	 * Get the point the cursor is moved to: the center of the region
+	 */
+	POINT GetTarget() const;
+
+	/**
+	 * Get a cell of the grid laid over the region. Cells are never empty: if the region has fewer pixels than the
+	 * grid has cells along an axis, neighboring cells share a pixel.
+	 *
+	 * @param region    Region the grid is laid over, not empty
+	 * @param gridSize  Number of the columns and of the rows of the grid
+	 * @param column    Column of the cell, from 0
+	 * @param row       Row of the cell, from 0
+	 */
+	static RECT GetCell(const RECT & region, int gridSize, int column, int row);
+
+	/**
+	 * Check the region math on the edge cases: regions of 1 to 3 pixels, even grids, and the narrowing of a whole
+	 * monitor down to a single pixel. Debug builds run it at startup.
+	 *
+	 * @return  False if any of the checks fails
+	 */
+	static bool SelfCheck();
+
+private:
+	RECT m_region = { 0, 0, 0, 0 };
+	int m_gridSize = kMaxGridSize;
+	bool m_isActive = false;
+};
+
+}}
\ No newline at end of file
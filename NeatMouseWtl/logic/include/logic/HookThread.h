@@ -10,20 +10,57 @@
 
 #pragma once
 
+#include <atomic>
+
 namespace neatmouse {
 namespace logic {
 
+class EngineContext;
+
 /**
  * Dedicated thread to process keyboard hooks 
+ *
+ * The system silently removes a low-level hook whose procedure runs longer than LowLevelHooksTimeout, so a watchdog
+ * thread keeps an eye on the callbacks: when one overruns the timeout, a fresh thread installs the hook anew and the
+ * previous one quits as soon as its callback returns. The events are processed by one callback at a time.
  */
 class HookThread
 {
 public:
-	static void Initialize(HINSTANCE hInst);
-	void operator() (HINSTANCE hInst);
+	/**
+	 * Start the thread; the keyboard events are processed by the actioner of the given context, which must outlive
+	 * the thread
+	 */
+	static void Initialize(HINSTANCE hInst, EngineContext & context);
+	void operator() (HINSTANCE hInst, unsigned long generation);
 
 private:
 	static LRESULT CALLBACK KeyboardProc(int nCode, WPARAM wParam, LPARAM lParam);
+	static void Watchdog();
+
+	/**
+	 * Replace the hook thread of the given generation with a fresh one, unless it has been replaced already
+	 */
+	static void Reinstall(unsigned long generation, LPCTSTR reason);
+
+	// low-level hooks carry no user data, so the hook procedure finds the context here
+	static EngineContext * s_context;
+	static HINSTANCE s_hInst;
+	static DWORD s_timeoutMs;
+
+	// generation of the current hook thread; the threads of the older generations are on their way out
+	static std::atomic<unsigned long> s_generation;
+
+	// generation of the newest hook thread started so far in the high half, its system id in the low half
+	static std::atomic<unsigned long long> s_thread;
+
+	// generation of the callback in progress in the high half, GetTickCount() when it started in the low half;
+	// 0 when there is none
+	static std::atomic<unsigned long long> s_callbackStart;
+
+	// set while a callback processes an event; the hook of a fresh thread passes the events on to the system until
+	// the callback of the replaced one returns, as the engine must not be entered by two threads
+	static std::atomic_flag s_processing;
 };
 
 }}
\ No newline at end of file
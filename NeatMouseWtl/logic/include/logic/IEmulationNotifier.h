@@ -20,7 +20,10 @@ struct IEmulationNotifier
 	using Ptr = std::shared_ptr<IEmulationNotifier>;
 	virtual void Notify(bool enabled) = 0;
 	virtual void TriggerOverlay(bool enabled) = 0;
-	virtual void UpdateOverlay() = 0;
+	virtual void MoveOverlay(LONG dx, LONG dy) = 0;
+	virtual void PlaceOverlay(LONG x, LONG y) = 0;
+	virtual void ShowTargetingGrid(const RECT & region, int gridSize) = 0;
+	virtual void HideTargetingGrid() = 0;
 	virtual ~IEmulationNotifier() = default;
 };
 
@@ -0,0 +1,38 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+
+#pragma once
+
+#include <memory>
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Destination of the mouse events generated by the emulation
+ */
+struct IMouseOutput
+{
+	using Ptr = std::shared_ptr<IMouseOutput>;
+	virtual void MouseMove(LONG dx, LONG dy) = 0;
+
+	/**
+	 * Move the cursor to the given point of the screen with a single absolute move
+	 */
+	virtual void MouseMoveTo(LONG x, LONG y) = 0;
+
+	virtual void MousePressMB(bool doUp) = 0;
+	virtual void MousePressLB(bool doUp) = 0;
+	virtual void MousePressRB(bool doUp) = 0;
+	virtual void MouseWheel(bool toUser) = 0;
+	virtual ~IMouseOutput() = default;
+};
+
+}}
\ No newline at end of file
@@ -0,0 +1,32 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include "logic/KeyboardUtils.h"
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Keyboard event as the emulation engine sees it, independently of the source it was captured from
+ */
+struct KeyEvent
+{
+	KeyboardUtils::VirtualKey_t vk = 0;
+	KeyboardUtils::ScanCode_t scanCode = 0;
+
+	// the key belongs to the extended set (right Ctrl and Alt, the arrows outside the numpad, ...)
+	bool isExtended = false;
+
+	// the event was synthesized by a program rather than typed
+	bool isInjected = false;
+};
+
+}}
\ No newline at end of file
@@ -9,7 +9,7 @@
 
 #pragma once
 
-#include <map>
+#include <string>
 #include <WTypes.h>
 
 namespace neatmouse {
@@ -40,6 +40,11 @@ public:
 	 */
 	static std::wstring GetKeyName(VirtualKey_t vk, ScanCode_t sc);
 
+	/** Return a textual name of the key using its virtual key code.
+	 *  Names are cached until the keyboard layout changes, so the function must only be called from the UI thread.
+	 */
+	static const std::wstring & GetKeyName(VirtualKey_t vk);
+
 	/** Generate a key down / key up event
 	 */
 	static void KeyPress(VirtualKey_t vk, bool doUp);
@@ -68,7 +73,8 @@ private:
 	KeyboardUtils() = delete;
 	~KeyboardUtils() = delete;
 
-	static const std::map<VirtualKey_t, std::wstring> kVirtualKeyToNameMap;
+	/// Virtual key codes are in the range 1..254, negative ones stand for keys with the extended flag set
+	static const VirtualKey_t kMaxVirtualKey = 0xFF;
 };
 
 }}
\ No newline at end of file
@@ -11,9 +11,11 @@
 
 #include <neatcommon/system/localization.h>
 #include <neatcommon/ui/CustomizedControls.h>
+#include "EngineContext.h"
 #include "IEmulationNotifier.h"
 #include "MouseParams.h"
 #include "MouseActioner.h"
+#include "MouseUtils.h"
 #include "OptionsHolder.h"
 
 namespace neatmouse {
@@ -27,28 +29,29 @@ public:
 	neatcommon::ui::CImageManager & GetImageManager() { return imageManager; }
 	neatcommon::system::CLocalizer & GetLocalizer() { return localizer; }
 	COptionsHolder & GetOptionsHolder() { return optionsHolder; }
-	MouseActioner & GetMouseActioner() { return mouseActioner; }
+	EngineContext & GetEngineContext() { return engineContext; }
+	MouseActioner & GetMouseActioner() { return engineContext.GetMouseActioner(); }
 
 	bool selectLocale(const std::string & langCode);
 
 	unsigned short Init(const std::vector<neatcommon::system::LocaleUiDescriptor> & iLocales);
-	MouseParams GetMouseParams();
+	const MouseParams & GetMouseParams() const;
 	void UpdateMouseParams(const MouseParams & params);
 	bool WereParametersChanged();
 	void AcceptMouseParams();
 	void RevertMouseParams();
 	void SetMouseParams(const MouseParams & value);
+	bool ReloadSettingsFiles(const std::vector<std::wstring> & filePaths);
 
 	void NotifyEnabling(bool enabled);
 	void TriggerOverlay();
-	void UpdateOverlay();
 	void SetEmulationNotifier(const IEmulationNotifier::Ptr & notifier);
 
 	const std::vector<neatcommon::system::LocaleUiDescriptor> & GetLocales() const;
 	const neatcommon::system::LocaleUiDescriptor & GetFallbackLocale() const;
 private:
-	IEmulationNotifier::Ptr emulationNotifier;
-	MouseActioner mouseActioner;
+	// the one engine of the application, injecting its events into the system
+	EngineContext engineContext{ std::make_shared<SystemMouseOutput>(), std::make_shared<SystemMotionClock>() };
 	HWND hwndMainWindow = NULL;
 	COptionsHolder optionsHolder;
 	MouseParams m_mouseParams;
@@ -0,0 +1,62 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Time source of the motion subsystem: the motion code reads the time, waits and gets the keyboard timings only
+ * through this interface
+ */
+struct IMotionClock
+{
+	using Ptr = std::shared_ptr<IMotionClock>;
+	using TimePoint_t = std::chrono::steady_clock::time_point;
+	using Duration_t = std::chrono::steady_clock::duration;
+
+	virtual TimePoint_t Now() = 0;
+
+	/**
+	 * Wait on the condition variable until the deadline
+	 *
+	 * @param condition  Condition variable notified to interrupt the wait
+	 * @param lock       Lock of the mutex associated with the condition variable, held by the caller
+	 * @param deadline   Time point to wait until
+	 *
+	 * @return  True if the deadline was reached, false if the wait was interrupted by a notification
+	 */
+	virtual bool WaitUntil(std::condition_variable & condition, std::unique_lock<std::mutex> & lock, TimePoint_t deadline) = 0;
+
+	virtual Duration_t GetKeyboardInitialDelay() = 0;
+	virtual Duration_t GetKeyboardRepeatPeriod() = 0;
+
+	virtual ~IMotionClock() = default;
+};
+
+
+/**
+ * Clock of the running application: monotonic time and the keyboard settings of the system
+ */
+class SystemMotionClock : public IMotionClock
+{
+public:
+	TimePoint_t Now() override;
+	bool WaitUntil(std::condition_variable & condition, std::unique_lock<std::mutex> & lock, TimePoint_t deadline) override;
+	Duration_t GetKeyboardInitialDelay() override;
+	Duration_t GetKeyboardRepeatPeriod() override;
+};
+
+}}
\ No newline at end of file
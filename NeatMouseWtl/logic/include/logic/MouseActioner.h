@@ -9,12 +9,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "logic/GridTargeting.h"
+#include "logic/KeyEvent.h"
 #include "logic/MouseEntities.h"
+#include "logic/MouseParams.h"
 #include "logic/RampUpCursorMover.h"
 
 namespace neatmouse {
 namespace logic {
 
+class EngineContext;
+
 /**
  * Descriptors of the currently pressed keyboard buttons
  */
@@ -40,47 +48,150 @@ struct KeyboardButtonsStatus
 class MouseActioner
 {
 public:
-	MouseActioner();
+	/**
+	 * @param context  Context the actioner belongs to, which provides the output for the generated mouse events
+	 */
+	explicit MouseActioner(EngineContext & context);
 	~MouseActioner();
 
 	/**
-	 * Process an event received from the keyboard hook callback
+	 * Process a keyboard event
 	 *
-	 * @param event    KBDLLHOOKSTRUCT received in LowLevelKeyboardProc
-	 * @param isKeyUp  event type received in LowLevelKeyboardProc
+	 * @param event    Event translated from the one received by the keyboard hook
+	 * @param isKeyUp  Flag indicating whether the key was released (true) or pressed (false)
 	 *
 	 * @return  A boolean indicating whether the processing was successful and should not be chained to the system
 	 */
-	bool processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp);
+	bool processAction(const KeyEvent & event, bool isKeyUp);
 
+	/**
+	 * Switch the emulation on or off, and check whether it is on; called by the UI. The enabler of the parameters last
+	 * set is used, whether the hook thread has taken them into use already or not.
+	 */
 	void activateEmulation(bool activate);
 	bool isEmulationActivated();
 	void reset();
+
+	/**
+	 * Replace the parameters the emulation works with. The hook thread takes them into use with the next event it
+	 * processes, or once the mouse buttons held at that moment (for example, during a drag) are released.
+	 */
 	void setMouseParams(const MouseParams& mouseParams);
 
+	/**
+	 * Get the snapshot of the parameters the emulation currently works with. The snapshot stays valid for as long as
+	 * the returned pointer is held, even if new parameters are set in the meantime.
+	 */
+	std::shared_ptr<const CompiledParams> getMouseParams() const;
+
+	/**
+	 * Check whether the key of the event is bound by the parameters the emulation currently works with, either as is
+	 * or as an extended key; called by the hook thread only
+	 */
+	bool isKeyBound(const KeyEvent & event) const;
+
+	/**
+	 * Get the timing statistics of the ramp-up movements
+	 */
+	MotionJitterStats getMotionJitterStats();
+
+	/**
+	 * Get the state of the emulation as a bit mask: the movement keys (bits 0-7), the left, right and middle buttons
+	 * (8-10), a sticky button (11), the activation, alternative speed and sticky modifiers (12-14), and the grid
+	 * targeting mode (15)
+	 */
+	std::uint16_t getStateMask() const;
+
+	/**
+	 * Set the scheduling of the threads performing the ramp-up movements
+	 */
+	void setThreadScheduling(const ThreadSchedulingOptions & options);
+
 private:
+	/**
+	 * Check whether a mouse button is currently held down by the emulation, directly or in "sticky button" mode
+	 */
+	bool isMouseButtonHeld() const;
+
+	/**
+	 * Get the parameters last set, whether the hook thread has taken them into use already or not, so that the UI
+	 * follows the enabler chosen at once. The hook thread never uses them: an event is processed with a single
+	 * snapshot, the one applied.
+	 */
+	std::shared_ptr<const CompiledParams> getLatestMouseParams() const;
+
+	/**
+	 * Check whether the emulation is on according to the enabler of the given parameters
+	 */
+	bool isEmulationActivated(const CompiledParams & params) const;
+
+	/**
+	 * Apply the parameters published by setMouseParams(), if there are any and no mouse button is held; called by the
+	 * hook thread only
+	 */
+	void applyPendingMouseParams();
+
 	/**
 	 * Terminate "sticky button" (click & drag) mode if (leads to the generation of "Mouse Up" even if the mode was on)
+	 *
+	 * @param params  Parameters snapshot the current event is processed with
 	 */
-	void resetStickyButton();
+	void resetStickyButton(const CompiledParams & params);
+
+	/**
+	 * Generate "Mouse Up" for every mouse button held by the emulation, including the sticky one, so that none stays
+	 * pressed once the keys holding it aren't tracked anymore
+	 *
+	 * @param params  Parameters snapshot the current event is processed with
+	 */
+	void releaseMouseButtons(const CompiledParams & params);
 
 	/**
 	 * Process a Key Up event
 	 *
-	 * @param vk  Virtual key code to process (after preprocessKey)
+	 * @param params  Parameters snapshot the current event is processed with
+	 * @param vk      Virtual key code to process (after preprocessKey)
 	 *
 	 * @return  True if the event was processed, false if it wasn't and its processing should be delegated to the system
 	 */
-	bool processKeyUp(KeyboardUtils::VirtualKey_t vk);
+	bool processKeyUp(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk);
 
 	/**
 	 * Process a Key Down event
 	 *
-	 * @param vk  Virtual key code to process (after preprocessKey)
+	 * @param params  Parameters snapshot the current event is processed with
+	 * @param vk      Virtual key code to process (after preprocessKey)
 	 *
 	 * @return  True if the event was processed, false if it wasn't and its processing should be delegated to the system
 	 */
-	bool processKeyDown(KeyboardUtils::VirtualKey_t vk);
+	bool processKeyDown(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk);
+
+	/**
+	 * Process an event in the grid targeting mode: the targeting key starts the mode and moves the cursor to the
+	 * target; while the mode is on, the movement keys (with the middle button key for the center) narrow the region
+	 * down, the left and right button keys move the cursor to the target before clicking, and Escape cancels.
+	 *
+	 * @param params   Parameters snapshot the current event is processed with
+	 * @param vk       Virtual key code to process (after preprocessKey)
+	 * @param isKeyUp  Flag indicating whether we're processing Key Up (true) or Key Down (false) event
+	 *
+	 * @return  True if the event was consumed by the targeting, false if it should be processed further
+	 */
+	bool processTargetingKey(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk, bool isKeyUp);
+
+	/**
+	 * Start the grid targeting over the monitor the cursor is on
+	 *
+	 * @param params  Parameters snapshot the current event is processed with
+	 */
+	void startTargeting(const CompiledParams & params);
+
+	/**
+	 * Leave the grid targeting mode
+	 *
+	 * @param moveCursor  Flag indicating whether the cursor should be moved to the target (true) or stay (false)
+	 */
+	void finishTargeting(bool moveCursor);
 
 	/**
 	 * Check the pressed status of the provided modifier button and indicates whether the current keyboard event should be
@@ -98,18 +209,28 @@ private:
 	bool checkModifierButtonDown(int vk, int modifier, bool isKeyUp, bool isNumlockSpecial, bool & oValue);
 
 	/**
-	 * Deduce a virtual key code of key being processed from the information provided in the KBDLLHOOKSTRUCT.
+	 * Deduce a virtual key code of key being processed from the information provided in the event.
 	 *
-	 * @param event  KBDLLHOOKSTRUCT received by the LowLevelKeyboardProc
+	 * @param event  Event being processed
    *
 	 * @return  A pair containing virtual key code and a boolean indicating if we're processing a key from the numerical
 	 *          keyboard with a Shift key pressed.
 	 */
-	std::pair<KeyboardUtils::VirtualKey_t, bool> preprocessKey(const KBDLLHOOKSTRUCT & event);
+	std::pair<KeyboardUtils::VirtualKey_t, bool> preprocessKey(const KeyEvent & event);
 
+	EngineContext & _context;
 	RampUpCursorMover _rampUpCursorMover;
 	KeyboardButtonsStatus _keyboardStatus;
-	MouseParams _mouseParams;
+	GridTargeting _gridTargeting;
+
+	// last key pressed in the targeting mode, so that its autorepeat doesn't narrow the region again
+	KeyboardUtils::VirtualKey_t _lastTargetingKey = MouseParams::kVKNone;
+
+	// published with std::atomic_load/atomic_store only: written by the UI thread, read by the hook thread. MSVC
+	// implements them for shared_ptr with a lock from a global spinlock pool, so they are short but not lock-free.
+	std::shared_ptr<const CompiledParams> _mouseParams;
+	std::shared_ptr<const CompiledParams> _pendingMouseParams;
+	std::atomic<bool> _hasPendingMouseParams{ false };
 
 	enum class LastShift_t
 	{
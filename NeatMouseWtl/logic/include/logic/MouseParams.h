@@ -43,6 +43,10 @@ public:
 	KeyboardUtils::VirtualKey_t VKWheelDown       = VK_MULTIPLY;
 	KeyboardUtils::VirtualKey_t VKActivationMod   = kVKNone;
 	KeyboardUtils::VirtualKey_t VKStickyKey       = kVKNone;
+	KeyboardUtils::VirtualKey_t VKTargeting       = kVKNone;
+
+	// columns and rows of the grid of the targeting mode
+	int targetingGridSize = 3;
 
 	UINT modHotkey = VK_F10;
 	UINT VKHotkey  = MOD_CONTROL | MOD_ALT;
@@ -59,7 +63,7 @@ public:
 	bool UseHotkey() const;
 	bool IsEqual(const MouseParams & mouseParams) const;
 
-	bool BindingExists(int keyCode);
+	bool BindingExists(int keyCode) const;
 	bool Save();
 	bool Save(const std::wstring & fileName);
 	bool Load(const std::wstring & fileName);
@@ -71,4 +75,46 @@ private:
 	std::wstring m_filePath;
 };
 
+
+/**
+ * Immutable snapshot of the MouseParams fields used while processing keyboard events. Snapshots are published to the
+ * hook thread as shared_ptr<const CompiledParams> and are never modified afterwards, so they can be read there
+ * without copying the preset name and file path. Only taking the pointer involves a short lock, see MouseActioner.
+ */
+struct CompiledParams
+{
+	explicit CompiledParams(const MouseParams & params);
+
+	LONG delta;
+	LONG adelta;
+
+	KeyboardUtils::VirtualKey_t VKEnabler;
+	KeyboardUtils::VirtualKey_t VKMoveUp;
+	KeyboardUtils::VirtualKey_t VKMoveDown;
+	KeyboardUtils::VirtualKey_t VKMoveLeft;
+	KeyboardUtils::VirtualKey_t VKMoveRight;
+	KeyboardUtils::VirtualKey_t VKMoveLeftUp;
+	KeyboardUtils::VirtualKey_t VKMoveRightUp;
+	KeyboardUtils::VirtualKey_t VKMoveLeftDown;
+	KeyboardUtils::VirtualKey_t VKMoveRightDown;
+	KeyboardUtils::VirtualKey_t VKAccelerated;
+	KeyboardUtils::VirtualKey_t VKPressLB;
+	KeyboardUtils::VirtualKey_t VKPressRB;
+	KeyboardUtils::VirtualKey_t VKPressMB;
+	KeyboardUtils::VirtualKey_t VKWheelUp;
+	KeyboardUtils::VirtualKey_t VKWheelDown;
+	KeyboardUtils::VirtualKey_t VKActivationMod;
+	KeyboardUtils::VirtualKey_t VKStickyKey;
+	KeyboardUtils::VirtualKey_t VKTargeting;
+
+	int targetingGridSize;
+
+	bool useHotkey;
+	bool changeCursor;
+	bool showNotifications;
+
+	bool UseHotkey() const { return useHotkey; }
+	bool BindingExists(KeyboardUtils::VirtualKey_t keyCode) const;
+};
+
 }}
\ No newline at end of file
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "logic/IMouseOutput.h"
+
 namespace neatmouse {
 namespace logic {
 
@@ -19,14 +21,34 @@ class MouseUtils
 {
 public:
 	static void MouseMove(LONG dx, LONG dy);
+	static void MouseMoveTo(LONG x, LONG y);
 	static void MousePressMB(bool doUp);
 	static void MousePressLB(bool doUp);
 	static void MousePressRB(bool doUp);
 	static void MouseWheel(bool toUser);
 
+	/**
+	 * Get the bounds of the monitor the cursor is on, in screen coordinates
+	 */
+	static RECT GetCursorMonitorRect();
+
 private:
 	MouseUtils() = delete;
 	~MouseUtils() = delete;
 };
 
+
+/**
+ * Mouse output injecting the events into the system
+ */
+struct SystemMouseOutput : IMouseOutput
+{
+	void MouseMove(LONG dx, LONG dy) override { MouseUtils::MouseMove(dx, dy); }
+	void MouseMoveTo(LONG x, LONG y) override { MouseUtils::MouseMoveTo(x, y); }
+	void MousePressMB(bool doUp) override { MouseUtils::MousePressMB(doUp); }
+	void MousePressLB(bool doUp) override { MouseUtils::MousePressLB(doUp); }
+	void MousePressRB(bool doUp) override { MouseUtils::MousePressRB(doUp); }
+	void MouseWheel(bool toUser) override { MouseUtils::MouseWheel(toUser); }
+};
+
 }}
\ No newline at end of file
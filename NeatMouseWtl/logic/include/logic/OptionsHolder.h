@@ -10,6 +10,7 @@
 #pragma once
 
 #include "MouseParams.h"
+#include "ThreadScheduling.h"
 
 namespace neatmouse {
 namespace logic {
@@ -28,14 +29,28 @@ public:
 	MouseParams CreateNewSettings(const std::wstring & proposedName);
 	void DeleteSettings(const std::wstring & name);
 
+	/**
+	 * Re-read the presets stored in the given files, leaving all the other presets untouched.
+	 * Passing the options folder itself reloads everything.
+	 *
+	 * @return  Names of the presets which were added, removed or re-read
+	 */
+	std::vector<std::wstring> ReloadSettingsFiles(const std::vector<std::wstring> & filePaths);
+
 	void SetOptionsFolder(const std::wstring & path);
 	std::wstring GetOptionsFolder() const;
 
 	std::string GetLanguageCode() const;
 	void SetLanguageCode(const std::string & langCode);
 
+	/**
+	 * Scheduling of the hook and motion threads; there is no UI for it, it is set in the settings file only
+	 */
+	const ThreadSchedulingOptions & GetThreadScheduling() const;
+
 protected:
 	std::string m_lang;
+	ThreadSchedulingOptions m_threadScheduling;
 	std::wstring m_defaultSettingsName;
 	std::wstring m_optionsFolder;
 	std::map<std::wstring, MouseParams> m_settings;
@@ -9,26 +9,96 @@
 
 #pragma once
 
+#include <array>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <thread>
+
+#include "logic/MotionClock.h"
+#include "logic/ThreadScheduling.h"
 
 namespace neatmouse {
 namespace logic {
 
+/**
+ * Lateness of the motion steps relative to their ideal deadlines
+ */
+struct MotionJitterStats
+{
+	unsigned long ticks;        // wake-ups which performed a step
+	unsigned long missedTicks;  // steps merged into a later one because the thread woke up too late
+	double meanLatenessUs;
+	double p99LatenessUs;
+};
+
+
+/**
+ * Repeats a move until the keyboard auto-repeat takes over; every step is performed by the move callback
+ */
 class RampUpCursorMover
 {
 public:
-	using MoveCallback_t = std::function<void()>;
+	using MoveCallback_t = std::function<void(LONG dx, LONG dy)>;
+
+	/**
+	 * @param clock  Source of the time and of the keyboard timings, must outlive the mover
+	 */
+	explicit RampUpCursorMover(IMotionClock & clock);
+	~RampUpCursorMover();
+
+	RampUpCursorMover(const RampUpCursorMover &) = delete;
+	RampUpCursorMover & operator=(const RampUpCursorMover &) = delete;
+
+	/**
+	 * Stop the current move and hand a new one over to the motion thread; neither allocates nor starts a thread, so
+	 * it may be called from the keyboard hook
+	 */
 	void moveAsync(LONG dx, LONG dy);
 	void stopMove();
-	void operator() (LONG dx, LONG dy);
+
 	void setMoveCallback(const MoveCallback_t & callbackFn);
 
+	/**
+	 * Set the scheduling of the motion thread, applied from its next move
+	 */
+	void setThreadScheduling(const ThreadSchedulingOptions & options);
+
+	MotionJitterStats getJitterStats();
+
 private:
+	void move(LONG dx, LONG dy, unsigned long generation, std::unique_lock<std::mutex> & lk);
+	void motionThread();
+	void recordLateness(IMotionClock::Duration_t lateness, LONG steps);
+
+	static constexpr long long kLatenessBucketUs = 100;
+	static constexpr std::size_t kLatenessBucketCount = 200;
+
+	IMotionClock & m_clock;
 	std::condition_variable m_condition;
 	std::mutex m_mutex;
 	MoveCallback_t m_moveCallback;
+
+	// incremented each time the current move is stopped, guarded by m_mutex
+	unsigned long m_generation = 0;
+	ThreadSchedulingOptions m_threadScheduling;
+	bool m_threadSchedulingChanged = false;
+
+	// move handed over to the motion thread, guarded by m_mutex
+	bool m_hasRequest = false;
+	bool m_quit = false;
+	LONG m_requestDx = 0;
+	LONG m_requestDy = 0;
+	unsigned long m_requestGeneration = 0;
+
+	// guarded by m_mutex; the last bucket gathers everything above the range
+	std::array<unsigned long, kLatenessBucketCount> m_latenessHistogram{};
+	long long m_latenessSumUs = 0;
+	unsigned long m_ticks = 0;
+	unsigned long m_missedTicks = 0;
+
+	// declared last: started once everything it uses is constructed
+	std::thread m_thread;
 };
 
 }}
\ No newline at end of file
@@ -0,0 +1,63 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include "logic/MotionClock.h"
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Clock of the motion checks: the time only moves when the check advances it, so that the motion runs faster than
+ * real time and with exactly the same timings on every run. A wait releases the lock of the caller like a real one,
+ * and returns once the time reaches its deadline or the condition variable is notified. Only one thread may wait on
+ * the clock at a time.
+ */
+class SimulatedMotionClock : public IMotionClock
+{
+public:
+	SimulatedMotionClock(Duration_t initialDelay, Duration_t repeatPeriod);
+
+	TimePoint_t Now() override;
+	bool WaitUntil(std::condition_variable & condition, std::unique_lock<std::mutex> & lock, TimePoint_t deadline) override;
+	Duration_t GetKeyboardInitialDelay() override;
+	Duration_t GetKeyboardRepeatPeriod() override;
+
+	/**
+	 * Wait, in real time, until a thread waits on the clock
+	 *
+	 * @param timeout    Real time to give up after
+	 * @param oDeadline  Deadline the thread waits until
+	 *
+	 * @return  False if no thread started waiting in time
+	 */
+	bool WaitForWaiter(std::chrono::milliseconds timeout, TimePoint_t & oDeadline);
+
+	/**
+	 * Move the time forward to the given point, waking the waiting thread up if its deadline is reached; the time
+	 * never goes backwards
+	 */
+	void AdvanceTo(TimePoint_t time);
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_waiterChanged;
+	TimePoint_t m_now;
+	const Duration_t m_initialDelay;
+	const Duration_t m_repeatPeriod;
+
+	// thread waiting on the clock, guarded by m_mutex
+	bool m_hasWaiter = false;
+	TimePoint_t m_waiterDeadline;
+	std::condition_variable * m_waiterCondition = nullptr;
+	std::mutex * m_waiterMutex = nullptr;
+};
+
+}}
\ No newline at end of file
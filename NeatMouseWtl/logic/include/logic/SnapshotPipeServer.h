@@ -0,0 +1,45 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Serves snapshots on the named pipe \\.\pipe\<name>.<session id>: every client connecting to it receives the bytes
+ * returned by the snapshot callback (invoked on the server thread), after which the pipe is closed
+ */
+class SnapshotPipeServer
+{
+public:
+	using SnapshotCallback_t = std::function<std::string()>;
+
+	SnapshotPipeServer() = default;
+	SnapshotPipeServer(const SnapshotPipeServer &) = delete;
+	SnapshotPipeServer & operator=(const SnapshotPipeServer &) = delete;
+	~SnapshotPipeServer();
+
+	bool Start(const std::wstring & name, const SnapshotCallback_t & snapshot);
+	void Stop();
+
+private:
+	void operator() ();
+
+	std::wstring m_pipeName;
+	SnapshotCallback_t m_snapshot;
+	HANDLE m_stopEvent = NULL;
+	std::thread m_thread;
+};
+
+}}
\ No newline at end of file
@@ -0,0 +1,60 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+namespace neatmouse {
+namespace logic {
+
+/**
+ * Scheduling of the threads on the path of the input: the keyboard hook thread and the motion threads
+ */
+struct ThreadSchedulingOptions
+{
+	enum class Priority_t
+	{
+		kDefault = 0,
+		kHighest = 1,
+		kTimeCritical = 2
+	};
+
+	Priority_t priority = Priority_t::kDefault;
+
+	// register the threads with the "Games" task of the Multimedia Class Scheduler Service (Vista and later)
+	bool useMmcss = false;
+
+	// processors the threads may run on, 0 not to pin them
+	DWORD_PTR affinityMask = 0;
+};
+
+
+/**
+ * Applies the scheduling options to the calling thread for the lifetime of the object
+ */
+class ScopedThreadScheduling
+{
+public:
+	explicit ScopedThreadScheduling(const ThreadSchedulingOptions & options);
+	~ScopedThreadScheduling();
+
+	/**
+	 * Replace the options applied to the thread
+	 */
+	void Apply(const ThreadSchedulingOptions & options);
+
+	ScopedThreadScheduling(const ScopedThreadScheduling &) = delete;
+	ScopedThreadScheduling & operator=(const ScopedThreadScheduling &) = delete;
+
+private:
+	void RevertMmcss();
+
+	HANDLE m_mmcssTask = NULL;
+};
+
+}}
\ No newline at end of file
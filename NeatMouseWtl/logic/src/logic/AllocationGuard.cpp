@@ -0,0 +1,87 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include <crtdbg.h>
+
+#include "logic/AllocationGuard.h"
+
+namespace neatmouse {
+namespace logic {
+
+namespace {
+
+// per thread, so that the other threads allocating meanwhile don't trip the check
+thread_local int t_guardDepth = 0;
+thread_local unsigned long t_allocationCount = 0;
+
+#ifdef _DEBUG
+
+_CRT_ALLOC_HOOK g_previousHook = nullptr;
+
+//---------------------------------------------------------------------------------------------------------------------
+int __cdecl AllocationHook(int allocType, void * userData, size_t size, int blockType, long requestNumber,
+	const unsigned char * filename, int lineNumber)
+{
+	if ((t_guardDepth > 0) && (allocType != _HOOK_FREE)) ++t_allocationCount;
+
+	if (g_previousHook != nullptr)
+	{
+		return g_previousHook(allocType, userData, size, blockType, requestNumber, filename, lineNumber);
+	}
+	return TRUE;
+}
+
+#endif
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+InstallAllocationGuard()
+{
+#ifdef _DEBUG
+	g_previousHook = _CrtSetAllocHook(&AllocationHook);
+#endif
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+NoAllocationScope::NoAllocationScope() :
+	m_allocationsBefore(t_allocationCount)
+{
+	++t_guardDepth;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+NoAllocationScope::~NoAllocationScope()
+{
+	--t_guardDepth;
+	assert(t_allocationCount == m_allocationsBefore && "heap allocation on the per-event path");
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+AllowAllocationScope::AllowAllocationScope() :
+	m_savedDepth(t_guardDepth)
+{
+	t_guardDepth = 0;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+AllowAllocationScope::~AllowAllocationScope()
+{
+	t_guardDepth = m_savedDepth;
+}
+
+}}
\ No newline at end of file
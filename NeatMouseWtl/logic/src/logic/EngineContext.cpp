@@ -0,0 +1,224 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "logic/AllocationGuard.h"
+#include "logic/EngineContext.h"
+
+namespace neatmouse {
+namespace logic {
+
+namespace {
+
+/**
+ * Passes the mouse events on to the output of the context, counting them
+ */
+class CountingMouseOutput : public IMouseOutput
+{
+public:
+	CountingMouseOutput(const IMouseOutput::Ptr & output, EngineCounters & counters) :
+		m_output(output),
+		m_counters(counters)
+	{
+	}
+
+	void MouseMove(LONG dx, LONG dy) override { Count(); m_output->MouseMove(dx, dy); }
+	void MouseMoveTo(LONG x, LONG y) override { Count(); m_output->MouseMoveTo(x, y); }
+	void MousePressMB(bool doUp) override { Count(); m_output->MousePressMB(doUp); }
+	void MousePressLB(bool doUp) override { Count(); m_output->MousePressLB(doUp); }
+	void MousePressRB(bool doUp) override { Count(); m_output->MousePressRB(doUp); }
+	void MouseWheel(bool toUser) override { Count(); m_output->MouseWheel(toUser); }
+
+private:
+	void Count() { EngineCounters::Increment(m_counters.mouseInjections); }
+
+	const IMouseOutput::Ptr m_output;
+	EngineCounters & m_counters;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void AppendMetric(std::string & oText, const char * name, const char * type, const char * help, double value)
+{
+	char line[64];
+	sprintf_s(line, "%.15g", value);
+	oText.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	oText.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+	oText.append(name).append(" ").append(line).append("\n");
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+EngineContext::EngineContext(const IMouseOutput::Ptr & output, const IMotionClock::Ptr & clock) :
+	mouseOutput(output ? std::make_shared<CountingMouseOutput>(output, counters) : nullptr),
+	motionClock(clock),
+	mouseActioner(*this)
+{
+	assert(mouseOutput);
+	assert(motionClock);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::SetEmulationNotifier(const IEmulationNotifier::Ptr & notifier)
+{
+	emulationNotifier = notifier;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::SetThreadScheduling(const ThreadSchedulingOptions & options)
+{
+	{
+		std::lock_guard<std::mutex> lock(threadSchedulingMutex);
+		threadScheduling = options;
+	}
+	mouseActioner.setThreadScheduling(options);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+ThreadSchedulingOptions
+EngineContext::GetThreadScheduling()
+{
+	std::lock_guard<std::mutex> lock(threadSchedulingMutex);
+	return threadScheduling;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::MoveCursor(LONG dx, LONG dy)
+{
+	mouseOutput->MouseMove(dx, dy);
+	if (emulationNotifier)
+	{
+		EngineCounters::Increment(counters.overlayUpdates);
+		emulationNotifier->MoveOverlay(dx, dy);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::MoveCursorTo(LONG x, LONG y)
+{
+	mouseOutput->MouseMoveTo(x, y);
+	if (emulationNotifier)
+	{
+		EngineCounters::Increment(counters.overlayUpdates);
+		emulationNotifier->PlaceOverlay(x, y);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::ShowTargetingGrid(const RECT & region, int gridSize)
+{
+	if (emulationNotifier)
+	{
+		emulationNotifier->ShowTargetingGrid(region, gridSize);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::HideTargetingGrid()
+{
+	if (emulationNotifier)
+	{
+		emulationNotifier->HideTargetingGrid();
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::NotifyEnabling(bool enabled)
+{
+	// toggling the emulation is rare and may show a balloon
+	const AllowAllocationScope allowAllocation;
+
+	if (!enabled)
+	{
+		const MotionJitterStats stats = mouseActioner.getMotionJitterStats();
+		ATLTRACE(_T("Motion ticks: %lu performed, %lu missed, lateness %.0f us mean, %.0f us p99\n"),
+			stats.ticks, stats.missedTicks, stats.meanLatenessUs, stats.p99LatenessUs);
+
+		const EventProcessingStats eventStats = eventProcessingHistogram.GetStats();
+		ATLTRACE(_T("Keyboard events: %lu processed, %.2f us mean, %.2f us p99, %.2f us max\n"),
+			eventStats.events, eventStats.meanUs, eventStats.p99Us, eventStats.maxUs);
+	}
+
+	if (!emulationNotifier) return;
+
+	// called from the hook thread: use the snapshot published to the actioner rather than the UI thread's copy
+	if (mouseActioner.getMouseParams()->showNotifications)
+	{
+		emulationNotifier->Notify(enabled);
+	}
+
+	// the decision just made on the hook thread is used rather than the enabler last set in the UI
+	emulationNotifier->TriggerOverlay(enabled && mouseActioner.getMouseParams()->changeCursor);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EngineContext::TriggerOverlay()
+{
+	const AllowAllocationScope allowAllocation;
+
+	if (emulationNotifier)
+	{
+		emulationNotifier->TriggerOverlay(mouseActioner.isEmulationActivated() && mouseActioner.getMouseParams()->changeCursor);
+	}
+}
+
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::string
+EngineContext::GetMetricsText()
+{
+	const auto read = [](const EngineCounters::Counter_t & counter)
+	{
+		return static_cast<double>(counter.load(std::memory_order_relaxed));
+	};
+
+	const unsigned long lastEventTick = counters.lastEventTick.load(std::memory_order_relaxed);
+	const EventProcessingStats eventStats = eventProcessingHistogram.GetStats();
+
+	std::string text;
+	AppendMetric(text, "neatmouse_hook_installed", "gauge", "Whether the keyboard hook is installed",
+		counters.hookInstalled.load(std::memory_order_relaxed) ? 1.0 : 0.0);
+	AppendMetric(text, "neatmouse_last_event_age_seconds", "gauge", "Time since the hook received its last event",
+		(lastEventTick == 0) ? -1.0 : (GetTickCount() - lastEventTick) / 1000.0);
+	AppendMetric(text, "neatmouse_hook_reinstalls_total", "counter", "Keyboard hooks installed anew after a callback overran the timeout", read(counters.hookReinstalls));
+	AppendMetric(text, "neatmouse_events_seen_total", "counter", "Keyboard events received by the hook", read(counters.eventsSeen));
+	AppendMetric(text, "neatmouse_events_blocked_total", "counter", "Keyboard events consumed by the emulation", read(counters.eventsBlocked));
+	AppendMetric(text, "neatmouse_events_passed_total", "counter", "Keyboard events passed on to the system", read(counters.eventsPassed));
+	AppendMetric(text, "neatmouse_mouse_injections_total", "counter", "Mouse events sent to the system", read(counters.mouseInjections));
+	AppendMetric(text, "neatmouse_ramp_starts_total", "counter", "Ramp-up moves started", read(counters.rampStarts));
+	AppendMetric(text, "neatmouse_overlay_updates_total", "counter", "Moves of the cursor overlay", read(counters.overlayUpdates));
+	AppendMetric(text, "neatmouse_resets_total", "counter", "Resets of the emulation state dropping held keys or buttons", read(counters.resets));
+	AppendMetric(text, "neatmouse_param_swaps_total", "counter", "Parameter snapshots taken into use", read(counters.paramSwaps));
+	AppendMetric(text, "neatmouse_event_processing_mean_seconds", "gauge", "Mean processing time of a keyboard event", eventStats.meanUs / 1e6);
+	AppendMetric(text, "neatmouse_event_processing_p99_seconds", "gauge", "99th percentile of the processing time of a keyboard event", eventStats.p99Us / 1e6);
+	return text;
+}
+
+}}
\ No newline at end of file
@@ -0,0 +1,58 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "logic/EventProcessingStats.h"
+
+namespace neatmouse {
+namespace logic {
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EventProcessingHistogram::Record(std::chrono::steady_clock::duration duration)
+{
+	const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+
+	std::size_t bucket = 0;
+	for (long long rest = ns >> 1; (rest > 0) && (bucket < kBucketCount - 1); rest >>= 1) ++bucket;
+
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	m_sumNs.fetch_add(ns, std::memory_order_relaxed);
+	if (ns > m_maxNs.load(std::memory_order_relaxed)) m_maxNs.store(ns, std::memory_order_relaxed);
+	m_events.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+EventProcessingStats
+EventProcessingHistogram::GetStats() const
+{
+	EventProcessingStats stats{ m_events.load(std::memory_order_relaxed), 0.0, 0.0, 0.0 };
+	if (stats.events == 0) return stats;
+
+	stats.meanUs = static_cast<double>(m_sumNs.load(std::memory_order_relaxed)) / stats.events / 1000.0;
+	stats.maxUs = static_cast<double>(m_maxNs.load(std::memory_order_relaxed)) / 1000.0;
+
+	// upper bound of the bucket containing the 99th percentile; the events recorded meanwhile only make it coarser
+	const unsigned long rank = stats.events - stats.events / 100;
+	unsigned long count = 0;
+	for (std::size_t i = 0; i < kBucketCount; ++i)
+	{
+		count += m_buckets[i].load(std::memory_order_relaxed);
+		if (count >= rank)
+		{
+			stats.p99Us = static_cast<double>(2ll << i) / 1000.0;
+			break;
+		}
+	}
+	return stats;
+}
+
+}}
\ No newline at end of file
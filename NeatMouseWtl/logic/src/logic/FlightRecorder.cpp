@@ -0,0 +1,132 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include <vector>
+
+#include "logic/FlightRecorder.h"
+
+namespace neatmouse {
+namespace logic {
+
+namespace {
+
+struct DumpHeader
+{
+	char signature[4];
+	std::uint32_t version;
+	std::uint32_t count;
+};
+
+constexpr std::uint32_t kDumpVersion = 1;
+
+
+//---------------------------------------------------------------------------------------------------------------------
+DumpHeader MakeHeader(std::size_t count)
+{
+	return DumpHeader{ { 'N', 'M', 'F', 'R' }, kDumpVersion, static_cast<std::uint32_t>(count) };
+}
+
+#ifdef _WIN32
+
+// everything the crash handler uses is prepared beforehand: the heap may be unusable by then
+const FlightRecorder * g_crashRecorder = nullptr;
+WCHAR g_crashDumpPath[MAX_PATH] = {};
+FlightRecord g_crashRecords[FlightRecorder::kCapacity];
+LPTOP_LEVEL_EXCEPTION_FILTER g_previousFilter = nullptr;
+
+
+//---------------------------------------------------------------------------------------------------------------------
+LONG WINAPI CrashFilter(EXCEPTION_POINTERS * exceptionInfo)
+{
+	const std::size_t count = g_crashRecorder->CopyRecords(g_crashRecords);
+	const HANDLE file = CreateFile(g_crashDumpPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		const DumpHeader header = MakeHeader(count);
+		DWORD written = 0;
+		WriteFile(file, &header, sizeof(header), &written, NULL);
+		WriteFile(file, g_crashRecords, static_cast<DWORD>(count * sizeof(FlightRecord)), &written, NULL);
+		CloseHandle(file);
+	}
+
+	return (g_previousFilter != nullptr) ? g_previousFilter(exceptionInfo) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+#endif
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+FlightRecorder::Record(const FlightRecord & record)
+{
+	const std::uint32_t written = m_written.load(std::memory_order_relaxed);
+	m_records[written % kCapacity] = record;
+	m_written.store(written + 1, std::memory_order_release);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::size_t
+FlightRecorder::CopyRecords(FlightRecord * oRecords) const
+{
+	const std::uint32_t end = m_written.load(std::memory_order_acquire);
+	const std::uint32_t available = (end < kCapacity) ? end : static_cast<std::uint32_t>(kCapacity);
+	for (std::uint32_t i = 0; i < available; ++i)
+	{
+		oRecords[i] = m_records[(end - available + i) % kCapacity];
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	// the records written during the copy, and the one which may be being written now, took the places of the oldest
+	// records: those of the copied ones which were hit may be torn
+	const std::uint32_t touched = m_written.load(std::memory_order_relaxed) - end + 1;
+	const std::uint32_t unused = static_cast<std::uint32_t>(kCapacity) - available;
+	const std::uint32_t skipped = (touched > unused) ? (touched - unused) : 0;
+	if (skipped >= available) return 0;
+
+	for (std::uint32_t i = skipped; i < available; ++i) oRecords[i - skipped] = oRecords[i];
+	return available - skipped;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::string
+FlightRecorder::GetDump() const
+{
+	std::vector<FlightRecord> records(kCapacity);
+	const std::size_t count = CopyRecords(records.data());
+
+	const DumpHeader header = MakeHeader(count);
+	std::string dump(reinterpret_cast<const char *>(&header), sizeof(header));
+	dump.append(reinterpret_cast<const char *>(records.data()), count * sizeof(FlightRecord));
+	return dump;
+}
+
+
+#ifdef _WIN32
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+InstallFlightRecorderCrashDump(const FlightRecorder & recorder)
+{
+	const DWORD length = GetTempPath(MAX_PATH, g_crashDumpPath);
+	if ((length == 0) || (length + wcslen(L"NeatMouse.nmfr") >= MAX_PATH)) return;
+	wcscat_s(g_crashDumpPath, L"NeatMouse.nmfr");
+
+	g_crashRecorder = &recorder;
+	g_previousFilter = SetUnhandledExceptionFilter(&CrashFilter);
+}
+
+#endif
+
+}}
\ No newline at end of file
@@ -0,0 +1,228 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "logic/GridTargeting.h"
+
+namespace neatmouse {
+namespace logic {
+
+namespace {
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+GetSpan(LONG first, LONG last, int count, int index, LONG & oFirst, LONG & oLast)
+{
+	// the boundaries are spread evenly, the remainder going to the cells after them
+	const LONG length = last - first;
+	oFirst = first + static_cast<LONG>((static_cast<long long>(length) * index) / count);
+	oLast = first + static_cast<LONG>((static_cast<long long>(length) * (index + 1)) / count);
+	if (oFirst == oLast)
+	{
+		if (oFirst == last) --oFirst; else ++oLast;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+int
+GetIndex(int direction, int gridSize)
+{
+	if (direction < 0) return 0;
+	if (direction > 0) return gridSize - 1;
+	return ((gridSize % 2) != 0) ? gridSize / 2 : -1;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+IsInside(const RECT & inner, const RECT & outer)
+{
+	return (inner.left >= outer.left) && (inner.right <= outer.right) && (inner.top >= outer.top) &&
+		(inner.bottom <= outer.bottom) && (inner.left < inner.right) && (inner.top < inner.bottom);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+CheckCells(const RECT & region, int gridSize)
+{
+	for (int row = 0; row < gridSize; ++row)
+	{
+		for (int column = 0; column < gridSize; ++column)
+		{
+			const RECT cell = GridTargeting::GetCell(region, gridSize, column, row);
+			if (!IsInside(cell, region)) return false;
+
+			// the cells cover the region from edge to edge, without gaps between the neighbors
+			if ((column == 0) && (cell.left != region.left)) return false;
+			if ((row == 0) && (cell.top != region.top)) return false;
+			if ((column == gridSize - 1) && (cell.right != region.right)) return false;
+			if ((row == gridSize - 1) && (cell.bottom != region.bottom)) return false;
+			if (column > 0)
+			{
+				const RECT previous = GridTargeting::GetCell(region, gridSize, column - 1, row);
+				if (cell.left > previous.right) return false;
+			}
+			if (row > 0)
+			{
+				const RECT previous = GridTargeting::GetCell(region, gridSize, column, row - 1);
+				if (cell.top > previous.bottom) return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+CheckNarrowingDown(const RECT & bounds, int gridSize, int horizontal, int vertical)
+{
+	GridTargeting targeting;
+	targeting.Start(bounds, gridSize);
+
+	// every step divides the region by the grid size at least, and a region of a pixel can't be narrowed further
+	for (int step = 0; targeting.CanNarrow(); ++step)
+	{
+		const RECT before = targeting.GetRegion();
+		if ((step > 64) || !targeting.Narrow(horizontal, vertical) || !IsInside(targeting.GetRegion(), before))
+		{
+			return false;
+		}
+	}
+
+	const RECT region = targeting.GetRegion();
+	const POINT target = targeting.GetTarget();
+	return (region.right - region.left == 1) && (region.bottom - region.top == 1) &&
+		(target.x == region.left) && (target.y == region.top) && IsInside(region, bounds);
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+GridTargeting::Start(const RECT & bounds, int gridSize)
+{
+	m_region = bounds;
+	if (m_region.right <= m_region.left) m_region.right = m_region.left + 1;
+	if (m_region.bottom <= m_region.top) m_region.bottom = m_region.top + 1;
+	m_gridSize = (gridSize < kMinGridSize) ? kMinGridSize : ((gridSize > kMaxGridSize) ? kMaxGridSize : gridSize);
+	m_isActive = true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+GridTargeting::Stop()
+{
+	m_isActive = false;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+GridTargeting::Narrow(int horizontal, int vertical)
+{
+	if (!m_isActive) return false;
+
+	const int column = GetIndex(horizontal, m_gridSize);
+	const int row = GetIndex(vertical, m_gridSize);
+	if ((column < 0) || (row < 0)) return false;
+
+	m_region = GetCell(m_region, m_gridSize, column, row);
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+GridTargeting::CanNarrow() const
+{
+	return (m_region.right - m_region.left > 1) || (m_region.bottom - m_region.top > 1);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+POINT
+GridTargeting::GetTarget() const
+{
+	POINT target;
+	target.x = m_region.left + (m_region.right - m_region.left - 1) / 2;
+	target.y = m_region.top + (m_region.bottom - m_region.top - 1) / 2;
+	return target;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+RECT
+GridTargeting::GetCell(const RECT & region, int gridSize, int column, int row)
+{
+	RECT cell;
+	GetSpan(region.left, region.right, gridSize, column, cell.left, cell.right);
+	GetSpan(region.top, region.bottom, gridSize, row, cell.top, cell.bottom);
+	return cell;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+GridTargeting::SelfCheck()
+{
+	for (int gridSize = kMinGridSize; gridSize <= kMaxGridSize; ++gridSize)
+	{
+		// regions smaller than the grid, where the neighboring cells share pixels
+		for (LONG width = 1; width <= 3; ++width)
+		{
+			for (LONG height = 1; height <= 3; ++height)
+			{
+				const RECT region = { -1, 5, -1 + width, 5 + height };
+				if (!CheckCells(region, gridSize)) return false;
+			}
+		}
+
+		const RECT monitor = { -1920, 0, 0, 1080 };
+		if (!CheckCells(monitor, gridSize)) return false;
+		for (int horizontal = -1; horizontal <= 1; ++horizontal)
+		{
+			for (int vertical = -1; vertical <= 1; ++vertical)
+			{
+				// an even grid has no middle cell: choosing it leaves the region as it is
+				const bool hasCell = ((gridSize % 2) != 0) || ((horizontal != 0) && (vertical != 0));
+				if (!hasCell)
+				{
+					GridTargeting targeting;
+					targeting.Start(monitor, gridSize);
+					const RECT before = targeting.GetRegion();
+					if (targeting.Narrow(horizontal, vertical)) return false;
+					const RECT after = targeting.GetRegion();
+					if ((after.left != before.left) || (after.top != before.top) ||
+					    (after.right != before.right) || (after.bottom != before.bottom))
+					{
+						return false;
+					}
+					continue;
+				}
+
+				if (!CheckNarrowingDown(monitor, gridSize, horizontal, vertical)) return false;
+			}
+		}
+	}
+
+	// the targeting doesn't narrow anything while it is off, and an empty region is widened to a pixel
+	GridTargeting targeting;
+	if (targeting.Narrow(-1, -1)) return false;
+	const RECT empty = { 10, 10, 10, 10 };
+	targeting.Start(empty, kMaxGridSize);
+	return !targeting.CanNarrow() && targeting.Narrow(0, 0) && !targeting.CanNarrow();
+}
+
+}}
\ No newline at end of file
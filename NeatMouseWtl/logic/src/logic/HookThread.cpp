@@ -10,30 +10,114 @@
 
 #include "stdafx.h"
 
+#include "logic/AllocationGuard.h"
+#include "logic/EngineContext.h"
 #include "logic/HookThread.h"
 #include "logic/KeyboardUtils.h"
-#include "logic/MainSingleton.h"
+#include "logic/ThreadScheduling.h"
 
+#include <chrono>
 #include <thread>
 
 namespace neatmouse {
 namespace logic {
 
+EngineContext * HookThread::s_context = nullptr;
+HINSTANCE HookThread::s_hInst = NULL;
+DWORD HookThread::s_timeoutMs = 0;
+std::atomic<unsigned long> HookThread::s_generation{ 0 };
+std::atomic<unsigned long long> HookThread::s_thread{ 0 };
+std::atomic<unsigned long long> HookThread::s_callbackStart{ 0 };
+std::atomic_flag HookThread::s_processing = ATOMIC_FLAG_INIT;
+
+namespace {
+
+// generation of the hook thread the hook procedure is running on
+thread_local unsigned long t_generation = 0;
+
 //---------------------------------------------------------------------------------------------------------------------
-void HookThread::Initialize(HINSTANCE hInst)
+unsigned long long MakeThreadRecord(unsigned long generation, DWORD threadId)
 {
-	std::thread(HookThread(), hInst).detach();
+	return (static_cast<unsigned long long>(generation) << 32) | threadId;
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void HookThread::operator() (HINSTANCE hInst)
+unsigned long long MakeCallbackStart(unsigned long generation, DWORD tick)
 {
-	KeyboardUtils::KeyPress(VK_CONTROL, false);
-	KeyboardUtils::KeyPress(VK_CONTROL, true);
+	// the tick is never 0, so that the value tells a callback in progress
+	return (static_cast<unsigned long long>(generation) << 32) | (tick | 1);
+}
 
-	HHOOK hook = SetWindowsHookEx(WH_KEYBOARD_LL, &KeyboardProc, hInst, 0);
+//---------------------------------------------------------------------------------------------------------------------
+DWORD ReadLowLevelHooksTimeout()
+{
+	// the value the system uses when none is set; since Windows 10 1709 the timeout is capped to a second anyway
+	DWORD timeoutMs = 300;
+
+	HKEY hOpened = NULL;
+	if (RegOpenKeyEx(HKEY_CURRENT_USER, _T("Control Panel\\Desktop"), 0, KEY_READ, &hOpened) == ERROR_SUCCESS)
+	{
+		DWORD value = 0;
+		DWORD valueSize = sizeof(value);
+		DWORD valueType = 0;
+		if ((RegQueryValueEx(hOpened, _T("LowLevelHooksTimeout"), NULL, &valueType, reinterpret_cast<LPBYTE>(&value), &valueSize) == ERROR_SUCCESS) &&
+		    (valueType == REG_DWORD) && (value > 0))
+		{
+			timeoutMs = value;
+		}
+		RegCloseKey(hOpened);
+	}
+
+	return (timeoutMs < 1000) ? timeoutMs : 1000;
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void HookThread::Initialize(HINSTANCE hInst, EngineContext & context)
+{
+	s_context = &context;
+	s_hInst = hInst;
+	s_timeoutMs = ReadLowLevelHooksTimeout();
+	s_generation = 1;
+	std::thread(HookThread(), hInst, 1ul).detach();
+	std::thread(&HookThread::Watchdog).detach();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void HookThread::operator() (HINSTANCE hInst, unsigned long generation)
+{
+	t_generation = generation;
+
+	// the message queue is created before the id is published, so that a WM_QUIT posted right away isn't lost
 	MSG msg;
+	PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+
+	// a thread starting late must not hide the id of a newer one
+	const unsigned long long record = MakeThreadRecord(generation, GetCurrentThreadId());
+	unsigned long long newest = s_thread.load();
+	while (((newest >> 32) < generation) && !s_thread.compare_exchange_weak(newest, record))
+	{
+	}
+
+	// replaced before it even started: Reinstall() may have found no id to post WM_QUIT to
+	if (generation != s_generation) return;
+
+	// a hook procedure answering too late is silently removed by the system, so the thread may be given precedence
+	const ScopedThreadScheduling scheduling(s_context->GetThreadScheduling());
+
+	// a reinstalled hook takes over while the keys may be held: the modifiers are reset at startup only
+	if (generation == 1)
+	{
+		KeyboardUtils::KeyPress(VK_CONTROL, false);
+		KeyboardUtils::KeyPress(VK_CONTROL, true);
+	}
+
+	HHOOK hook = SetWindowsHookEx(WH_KEYBOARD_LL, &KeyboardProc, hInst, 0);
+	if (generation == s_generation) s_context->GetCounters().hookInstalled = (hook != NULL);
 	BOOL bRet = -1;
 	while ((bRet = GetMessage(&msg, NULL, 0, 0)) != 0)
 	{
@@ -49,8 +133,47 @@ void HookThread::operator() (HINSTANCE hInst)
 	}
 
 	UnhookWindowsHookEx(hook);
-	KeyboardUtils::KeyPress(VK_CONTROL, false);
-	KeyboardUtils::KeyPress(VK_CONTROL, true);
+	if (generation == s_generation)
+	{
+		s_context->GetCounters().hookInstalled = false;
+		KeyboardUtils::KeyPress(VK_CONTROL, false);
+		KeyboardUtils::KeyPress(VK_CONTROL, true);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void HookThread::Watchdog()
+{
+	const DWORD period = (s_timeoutMs / 4 > 50) ? s_timeoutMs / 4 : 50;
+	for (;;)
+	{
+		Sleep(period);
+
+		const unsigned long long callbackStart = s_callbackStart.load(std::memory_order_relaxed);
+		const DWORD start = static_cast<DWORD>(callbackStart);
+		if ((start != 0) && (GetTickCount() - start > s_timeoutMs))
+		{
+			Reinstall(static_cast<unsigned long>(callbackStart >> 32), _T("the callback is overrunning the timeout"));
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void HookThread::Reinstall(unsigned long generation, LPCTSTR reason)
+{
+	unsigned long expected = generation;
+	if (!s_generation.compare_exchange_strong(expected, generation + 1)) return;
+
+	EngineCounters::Increment(s_context->GetCounters().hookReinstalls);
+	ATLTRACE(_T("Keyboard hook reinstalled: %s\n"), reason);
+
+	// the thread quits once its callback returns; the system may not have removed its hook, which is done then.
+	// A thread which hasn't published its id yet sees the new generation once it does, and quits by itself.
+	const unsigned long long thread = s_thread.load();
+	if ((thread >> 32) == generation) PostThreadMessage(static_cast<DWORD>(thread), WM_QUIT, 0, 0);
+	std::thread(HookThread(), s_hInst, generation + 1).detach();
 }
 
 
@@ -59,15 +182,80 @@ LRESULT CALLBACK HookThread::KeyboardProc(int nCode, WPARAM wParam, LPARAM lPara
 {
 	// MSDN docs specify that both LL keybd & mouse hook should return in this case.
 	if (nCode != HC_ACTION) return CallNextHookEx(NULL, nCode, wParam, lParam);
-	
-	const KBDLLHOOKSTRUCT &event = *(PKBDLLHOOKSTRUCT)lParam;
 
-	if (!MainSingleton::Instance().GetMouseActioner().processAction(event, (wParam == WM_KEYUP || wParam == WM_SYSKEYUP)))
+	// the hook of a replaced thread leaves the events to the current one
+	if (t_generation != s_generation.load(std::memory_order_relaxed)) return CallNextHookEx(NULL, nCode, wParam, lParam);
+
+	// the callback of a replaced thread may still be running; the events pass meanwhile rather than wait for it
+	if (s_processing.test_and_set(std::memory_order_acquire)) return CallNextHookEx(NULL, nCode, wParam, lParam);
+
+	const DWORD callbackStart = GetTickCount();
+	const unsigned long long ownCallbackStart = MakeCallbackStart(t_generation, callbackStart);
+	s_callbackStart.store(ownCallbackStart, std::memory_order_relaxed);
+
+	const KBDLLHOOKSTRUCT &hookEvent = *(PKBDLLHOOKSTRUCT)lParam;
+
+	EngineCounters & counters = s_context->GetCounters();
+	EngineCounters::Increment(counters.eventsSeen);
+	counters.lastEventTick.store(GetTickCount(), std::memory_order_relaxed);
+
+	KeyEvent event;
+	event.vk = static_cast<KeyboardUtils::VirtualKey_t>(hookEvent.vkCode);
+	event.scanCode = static_cast<KeyboardUtils::ScanCode_t>(hookEvent.scanCode);
+	event.isExtended = (hookEvent.flags & LLKHF_EXTENDED) != 0;
+	event.isInjected = (hookEvent.flags & LLKHF_INJECTED) != 0;
+
+	const bool isKeyUp = (wParam == WM_KEYUP || wParam == WM_SYSKEYUP);
+	MouseActioner & actioner = s_context->GetMouseActioner();
+	const std::uint16_t stateBefore = actioner.getStateMask();
+	const unsigned long injectionsBefore = counters.mouseInjections.load(std::memory_order_relaxed);
+
+	bool processed = false;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	{
+		// every key of the system goes through here: the processing must not touch the heap
+		const NoAllocationScope noAllocation;
+		processed = actioner.processAction(event, isKeyUp);
+	}
+	const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+	s_context->GetEventProcessingHistogram().Record(duration);
+
+	// the keys passed on to the system may be anything typed, passwords included: the keys bound by the profile are
+	// recorded, the others only when they change the state of the emulation, and then without the key
+	const std::uint16_t stateAfter = actioner.getStateMask();
+	const bool isKeyBound = processed || actioner.isKeyBound(event);
+	if (isKeyBound || (stateAfter != stateBefore))
+	{
+		const long long processingUs = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+		FlightRecord record;
+		record.time = hookEvent.time;
+		record.scanCode = isKeyBound ? static_cast<std::uint16_t>(hookEvent.scanCode) : 0;
+		record.vk = isKeyBound ? static_cast<std::uint8_t>(hookEvent.vkCode) : 0;
+		record.flags = static_cast<std::uint8_t>(
+			(isKeyUp ? FlightRecord::kKeyUp : 0) |
+			(event.isExtended ? FlightRecord::kExtended : 0) |
+			(event.isInjected ? FlightRecord::kInjected : 0) |
+			(processed ? FlightRecord::kBlocked : 0));
+		record.stateBefore = stateBefore;
+		record.stateAfter = stateAfter;
+		record.injections = static_cast<std::uint16_t>(counters.mouseInjections.load(std::memory_order_relaxed) - injectionsBefore);
+		record.processingUs = static_cast<std::uint16_t>((processingUs < 0xFFFF) ? processingUs : 0xFFFF);
+		s_context->GetFlightRecorder().Record(record);
+	}
+
+	EngineCounters::Increment(processed ? counters.eventsBlocked : counters.eventsPassed);
+
+	unsigned long long expected = ownCallbackStart;
+	s_callbackStart.compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+	s_processing.clear(std::memory_order_release);
+
+	// the system has probably dropped the hook already; if the watchdog has replaced it meanwhile, this does nothing
+	if (GetTickCount() - callbackStart > s_timeoutMs)
 	{
-		return CallNextHookEx(NULL, nCode, wParam, lParam);
+		Reinstall(t_generation, _T("the callback overran the timeout"));
 	}
 
-	return 1;
+	return processed ? 1 : CallNextHookEx(NULL, nCode, wParam, lParam);
 }
 
 }}
\ No newline at end of file
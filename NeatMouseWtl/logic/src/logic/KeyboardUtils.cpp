@@ -10,6 +10,9 @@
 
 #include "StdAfx.h"
 
+#include <array>
+#include <bitset>
+
 #include "logic/KeyboardUtils.h"
 
 namespace neatmouse {
@@ -50,12 +53,47 @@ const KeyboardUtils::ScanCode_t SC_NUMPADENTER = 0x11C;
 
 
 //=====================================================================================================================
-// KeyboardUtils
+// key names
 //=====================================================================================================================
 
+namespace {
+
+struct KeyNameEntry
+{
+	KeyboardUtils::VirtualKey_t vk;
+	const wchar_t * name;
+};
+
 //  key labels - translation needed?
-const std::map<KeyboardUtils::VirtualKey_t, std::wstring> KeyboardUtils::kVirtualKeyToNameMap
+//  sorted by the virtual key code for the binary search
+constexpr KeyNameEntry kVirtualKeyNames[]
 {
+	{VK_NUMPADENTER,         L"Num Enter"},
+	{VK_CANCEL,              L"Ctrl-Break"},
+	{VK_BACK,                L"Backspace"},
+	{VK_TAB,                 L"Tab"},
+	{VK_CLEAR,               L"Num Clear"},
+	{VK_RETURN,              L"Enter"},
+	{VK_PAUSE,               L"Pause"},
+	{VK_CAPITAL,             L"Caps Lock"},
+	{VK_ESCAPE,              L"Escape"},
+	{VK_SPACE,               L"Space"},
+	{VK_PRIOR,               L"Num PgUp"},
+	{VK_NEXT,                L"Num PgDn"},
+	{VK_END,                 L"Num End"},
+	{VK_HOME,                L"Num Home"},
+	{VK_LEFT,                L"Num Left"},
+	{VK_UP,                  L"Num Up"},
+	{VK_RIGHT,               L"Num Right"},
+	{VK_DOWN,                L"Num Down"},
+	{VK_SNAPSHOT,            L"Print Screen"},
+	{VK_INSERT,              L"Num Ins"},
+	{VK_DELETE,              L"Num Del"},
+	{VK_HELP,                L"Help"},
+	{VK_LWIN,                L"Left Win"},
+	{VK_RWIN,                L"Right Win"},
+	{VK_APPS,                L"Menu"},
+	{VK_SLEEP,               L"Sleep"},
 	{VK_NUMPAD0,             L"Num 0"},
 	{VK_NUMPAD1,             L"Num 1"},
 	{VK_NUMPAD2,             L"Num 2"},
@@ -67,44 +105,10 @@ const std::map<KeyboardUtils::VirtualKey_t, std::wstring> KeyboardUtils::kVirtua
 	{VK_NUMPAD8,             L"Num 8"},
 	{VK_NUMPAD9,             L"Num 9"},
 	{VK_MULTIPLY,            L"Num *"},
-	{VK_DIVIDE,              L"Num /"},
 	{VK_ADD,                 L"Num +"},
 	{VK_SUBTRACT,            L"Num -"},
 	{VK_DECIMAL,             L"Num ."},
-	{VK_NUMLOCK,             L"Num Lock"},
-	{VK_SCROLL,              L"Scroll Lock"},
-	{VK_CAPITAL,             L"Caps Lock"},
-	{VK_ESCAPE,              L"Escape"},
-	{VK_TAB,                 L"Tab"},
-	{VK_SPACE,               L"Space"},
-	{VK_BACK,                L"Backspace"},
-	{VK_RETURN,              L"Enter"},
-	{VK_NUMPADENTER,         L"Num Enter"},
-	{VK_DELETE,              L"Num Del"},
-	{VK_INSERT,              L"Num Ins"},
-	{VK_CLEAR,               L"Num Clear"},
-	{VK_UP,                  L"Num Up"},
-	{VK_DOWN,                L"Num Down"},
-	{VK_LEFT,                L"Num Left"},
-	{VK_RIGHT,               L"Num Right"},
-	{VK_HOME,                L"Num Home"},
-	{VK_END,                 L"Num End"},
-	{VK_PRIOR,               L"Num PgUp"},
-	{VK_NEXT,                L"Num PgDn"},
-	{VK_SNAPSHOT,            L"Print Screen"},
-	{VK_CANCEL,              L"Ctrl-Break"},
-	{VK_PAUSE,               L"Pause"},
-	{VK_HELP,                L"Help"},
-	{VK_SLEEP,               L"Sleep"},
-	{VK_APPS,                L"Menu"},
-	{VK_LCONTROL,            L"Left Ctrl"},
-	{VK_RCONTROL,            L"Right Ctrl"},
-	{VK_LSHIFT,              L"Left Shift"},
-	{VK_RSHIFT,              L"Right Shift"},
-	{VK_LMENU,               L"Left Alt"},
-	{VK_RMENU,               L"Right Alt"},
-	{VK_LWIN,                L"Left Win"},
-	{VK_RWIN,                L"Right Win"},
+	{VK_DIVIDE,              L"Num /"},
 	{VK_F1,                  L"F1"},
 	{VK_F2,                  L"F2"},
 	{VK_F3,                  L"F3"},
@@ -129,6 +133,14 @@ const std::map<KeyboardUtils::VirtualKey_t, std::wstring> KeyboardUtils::kVirtua
 	{VK_F22,                 L"F22"},
 	{VK_F23,                 L"F23"},
 	{VK_F24,                 L"F24"},
+	{VK_NUMLOCK,             L"Num Lock"},
+	{VK_SCROLL,              L"Scroll Lock"},
+	{VK_LSHIFT,              L"Left Shift"},
+	{VK_RSHIFT,              L"Right Shift"},
+	{VK_LCONTROL,            L"Left Ctrl"},
+	{VK_RCONTROL,            L"Right Ctrl"},
+	{VK_LMENU,               L"Left Alt"},
+	{VK_RMENU,               L"Right Alt"},
 	{VK_BROWSER_BACK,        L"Browser Back"},
 	{VK_BROWSER_FORWARD,     L"Browser Forward"},
 	{VK_BROWSER_REFRESH,     L"Browser Refresh"},
@@ -150,6 +162,35 @@ const std::map<KeyboardUtils::VirtualKey_t, std::wstring> KeyboardUtils::kVirtua
 };
 
 
+//---------------------------------------------------------------------------------------------------------------------
+constexpr bool IsSortedByVirtualKey(const KeyNameEntry * begin, const KeyNameEntry * end)
+{
+	for (const KeyNameEntry * it = begin; it + 1 < end; ++it)
+	{
+		if (it->vk >= (it + 1)->vk) return false;
+	}
+	return true;
+}
+
+static_assert(IsSortedByVirtualKey(std::begin(kVirtualKeyNames), std::end(kVirtualKeyNames)),
+	"kVirtualKeyNames must be sorted by the virtual key code");
+
+
+//---------------------------------------------------------------------------------------------------------------------
+const wchar_t * FindFixedKeyName(KeyboardUtils::VirtualKey_t vk)
+{
+	const auto it = std::lower_bound(std::begin(kVirtualKeyNames), std::end(kVirtualKeyNames), vk,
+		[](const KeyNameEntry & entry, KeyboardUtils::VirtualKey_t value) { return entry.vk < value; });
+	return (it != std::end(kVirtualKeyNames) && it->vk == vk) ? it->name : nullptr;
+}
+
+}
+
+
+//=====================================================================================================================
+// KeyboardUtils
+//=====================================================================================================================
+
 //---------------------------------------------------------------------------------------------------------------------
 KeyboardUtils::ScanCode_t KeyboardUtils::VirtualKeyToScanCode(VirtualKey_t vk)
 {
@@ -215,8 +256,7 @@ KeyboardUtils::VirtualKey_t KeyboardUtils::ScanCodeToVirtualKey(ScanCode_t sc)
 //---------------------------------------------------------------------------------------------------------------------
 std::wstring KeyboardUtils::GetKeyName(VirtualKey_t vk, ScanCode_t sc)
 {
-	static const std::wstring kDefaultName;
-	if ( (vk == 0) && (sc == 0) ) return kDefaultName;
+	if ( (vk == 0) && (sc == 0) ) return std::wstring();
 
 	if (vk == 0) vk = ScanCodeToVirtualKey(sc);
 	if (sc == 0) sc = VirtualKeyToScanCode(abs(vk));
@@ -227,19 +267,48 @@ std::wstring KeyboardUtils::GetKeyName(VirtualKey_t vk, ScanCode_t sc)
 		if (vk != VK_NUMPADENTER) vk = abs(vk);
 	}
 
-	static const std::set<ScanCode_t> ignoreSet {
-		SC_INSERT, SC_DELETE, SC_HOME, SC_END, SC_UP, SC_DOWN, SC_LEFT, SC_RIGHT, SC_PGUP, SC_PGDN };
-	if ( ignoreSet.find(sc) == ignoreSet.end() )
+	switch (sc)
 	{
-		auto it = kVirtualKeyToNameMap.find(vk);
-		if (it != kVirtualKeyToNameMap.end()) return it->second;
+		case SC_INSERT: case SC_DELETE: case SC_HOME: case SC_END: case SC_UP:
+		case SC_DOWN: case SC_LEFT: case SC_RIGHT: case SC_PGUP: case SC_PGDN:
+			break;
+		default:
+			if (const wchar_t * name = FindFixedKeyName(vk)) return name;
 	}
 
 	constexpr size_t kBufSize = 100;
 	wchar_t buf[kBufSize];
 	if ( GetKeyNameText(sc << 16, buf, kBufSize) ) return std::wstring(buf);
 
-	return kDefaultName;
+	return std::wstring();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+const std::wstring & KeyboardUtils::GetKeyName(VirtualKey_t vk)
+{
+	// names of keys without a fixed label come from the keyboard layout, so the cache lives as long as the layout
+	static HKL cachedLayout = nullptr;
+	static std::array<std::wstring, 2 * kMaxVirtualKey + 1> names;
+	static std::bitset<2 * kMaxVirtualKey + 1> resolved;
+
+	static const std::wstring kDefaultName;
+	if ( (vk == 0) || (vk < -kMaxVirtualKey) || (vk > kMaxVirtualKey) ) return kDefaultName;
+
+	const HKL layout = GetKeyboardLayout(0);
+	if (layout != cachedLayout)
+	{
+		cachedLayout = layout;
+		resolved.reset();
+	}
+
+	const size_t index = static_cast<size_t>(vk + kMaxVirtualKey);
+	if (!resolved[index])
+	{
+		names[index] = GetKeyName(vk, 0);
+		resolved[index] = true;
+	}
+	return names[index];
 }
 
 
@@ -263,34 +332,33 @@ KeyboardUtils::VirtualKey_t KeyboardUtils::TransformNumpadWithShift(VirtualKey_t
 {
 	bool isNumLockOn = (GetAsyncKeyState(VK_NUMLOCK) & 1) || (GetKeyState(VK_NUMLOCK) & 1);
 
-	// map: { scan code -> pair: 1) numpad's VK with NumLock off, 2) numpad's VK with NumLock on }
-	static const std::map<ScanCode_t, std::pair<VirtualKey_t, VirtualKey_t> > numpadKeyMap =
+	// scan code -> numpad's VK with NumLock off and with NumLock on; a switch rather than a table built on first use,
+	// since this runs in the keyboard hook
+	VirtualKey_t vkNumLockOff = 0;
+	VirtualKey_t vkNumLockOn = 0;
+	switch (sc)
+	{
+	case SC_NUMPAD8:   vkNumLockOff = VK_UP;     vkNumLockOn = VK_NUMPAD8; break;
+	case SC_NUMPAD2:   vkNumLockOff = VK_DOWN;   vkNumLockOn = VK_NUMPAD2; break;
+	case SC_NUMPAD4:   vkNumLockOff = VK_LEFT;   vkNumLockOn = VK_NUMPAD4; break;
+	case SC_NUMPAD6:   vkNumLockOff = VK_RIGHT;  vkNumLockOn = VK_NUMPAD6; break;
+	case SC_NUMPAD7:   vkNumLockOff = VK_HOME;   vkNumLockOn = VK_NUMPAD7; break;
+	case SC_NUMPAD9:   vkNumLockOff = VK_PRIOR;  vkNumLockOn = VK_NUMPAD9; break;
+	case SC_NUMPAD1:   vkNumLockOff = VK_END;    vkNumLockOn = VK_NUMPAD1; break;
+	case SC_NUMPAD3:   vkNumLockOff = VK_NEXT;   vkNumLockOn = VK_NUMPAD3; break;
+	case SC_NUMPAD5:   vkNumLockOff = VK_CLEAR;  vkNumLockOn = VK_NUMPAD5; break;
+	case SC_NUMPADDOT: vkNumLockOff = VK_DELETE; vkNumLockOn = VK_DECIMAL; break;
+	case SC_NUMPAD0:   vkNumLockOff = VK_INSERT; vkNumLockOn = VK_NUMPAD0; break;
+	default: return vk;
+	}
+
+	if ( isNumLockOn && (vkNumLockOff == vk) )
 	{
-		{ SC_NUMPAD8,   {VK_UP, VK_NUMPAD8}     },
-		{ SC_NUMPAD2,   {VK_DOWN, VK_NUMPAD2}   },
-		{ SC_NUMPAD4,   {VK_LEFT, VK_NUMPAD4}   },
-		{ SC_NUMPAD6,   {VK_RIGHT, VK_NUMPAD6}  },
-		{ SC_NUMPAD7,   {VK_HOME, VK_NUMPAD7}   },
-		{ SC_NUMPAD9,   {VK_PRIOR, VK_NUMPAD9}  },
-		{ SC_NUMPAD1,   {VK_END, VK_NUMPAD1}    },
-		{ SC_NUMPAD3,   {VK_NEXT, VK_NUMPAD3}   },
-		{ SC_NUMPAD5,   {VK_CLEAR, VK_NUMPAD5}  },
-		{ SC_NUMPADDOT, {VK_DELETE, VK_DECIMAL} },
-		{ SC_NUMPAD0,   {VK_INSERT, VK_NUMPAD0} }
-	};
-
-	auto it = numpadKeyMap.find(sc);
-	if (it != numpadKeyMap.end())
+		vk = vkNumLockOn;
+	} else
+	if ( !isNumLockOn && (vkNumLockOn == vk) )
 	{
-		const auto & aVkPair = it->second;
-		if ( isNumLockOn && (aVkPair.first == vk) )
-		{
-			vk = aVkPair.second;
-		} else
-		if ( !isNumLockOn && (aVkPair.second == vk) )
-		{
-			vk = aVkPair.first;
-		}
+		vk = vkNumLockOff;
 	}
 
 	return vk;
@@ -35,14 +35,7 @@ MainSingleton::Instance()
 void
 MainSingleton::NotifyEnabling(bool enabled)
 {
-	if (!emulationNotifier) return;
-
-	if (GetMouseParams().showNotifications)
-	{
-		emulationNotifier->Notify(enabled);
-	}
-
-	TriggerOverlay();
+	engineContext.NotifyEnabling(enabled);
 }
 
 
@@ -54,12 +47,7 @@ MainSingleton::selectLocale(const std::string & langCode)
 		[&langCode](const neatcommon::system::LocaleUiDescriptor & locale) {
 			return locale.code == langCode;
 		} );
-	if (it != locales.end())
-	{
-		localizer.load(it->fileId, L"LANG");
-		return true;
-	}
-	return false;
+	return (it != locales.end()) && localizer.load(it->fileId, L"LANG");
 }
 
 
@@ -95,7 +83,6 @@ unsigned short
 MainSingleton::Init(const std::vector<neatcommon::system::LocaleUiDescriptor> & iLocales)
 {
 	locales = iLocales;
-	selectLocale(GetFallbackLocale().code);
 
 	TCHAR szPath[MAX_PATH];
 	bool optionsLoaded = false;
@@ -135,7 +122,12 @@ MainSingleton::Init(const std::vector<neatcommon::system::LocaleUiDescriptor> &
 	}
 
 	SetMouseParams(optionsHolder.GetSettings(optionsHolder.GetDefaultSettingsName()));
-	selectLocale(optionsHolder.GetLanguageCode());
+	engineContext.SetThreadScheduling(optionsHolder.GetThreadScheduling());
+	// only the selected language is loaded; the fallback one is touched only if the selection is unknown or broken
+	if (!selectLocale(optionsHolder.GetLanguageCode()))
+	{
+		selectLocale(GetFallbackLocale().code);
+	}
 
 	SetLastError(0);
 	mutex = CreateMutex(NULL, FALSE, _T("NeatMouse"));
@@ -148,8 +140,8 @@ MainSingleton::Init(const std::vector<neatcommon::system::LocaleUiDescriptor> &
 
 
 //---------------------------------------------------------------------------------------------------------------------
-MouseParams
-MainSingleton::GetMouseParams()
+const MouseParams &
+MainSingleton::GetMouseParams() const
 {
 	return m_mouseParams;
 }
@@ -160,7 +152,7 @@ void
 MainSingleton::UpdateMouseParams(const MouseParams& params)
 {
 	m_mouseParams = params;
-	mouseActioner.setMouseParams(m_mouseParams);
+	engineContext.GetMouseActioner().setMouseParams(m_mouseParams);
 }
 
 
@@ -179,7 +171,7 @@ MainSingleton::AcceptMouseParams()
 	m_initialMouseParams = m_mouseParams;
 	optionsHolder.SetSettings(m_mouseParams.GetName(), m_mouseParams);
 	m_mouseParams.Save();
-	mouseActioner.setMouseParams(m_mouseParams);
+	engineContext.GetMouseActioner().setMouseParams(m_mouseParams);
 }
 
 
@@ -197,34 +189,49 @@ MainSingleton::SetMouseParams(const MouseParams & value)
 {
 	m_mouseParams = value;
 	m_initialMouseParams = m_mouseParams;
-	mouseActioner.setMouseParams(m_mouseParams);
+	engineContext.GetMouseActioner().setMouseParams(m_mouseParams);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void
-MainSingleton::SetEmulationNotifier(const IEmulationNotifier::Ptr & notifier)
+bool
+MainSingleton::ReloadSettingsFiles(const std::vector<std::wstring> & filePaths)
 {
-	emulationNotifier = notifier;
+	const std::vector<std::wstring> & changedNames = optionsHolder.ReloadSettingsFiles(filePaths);
+	if (changedNames.empty()) return false;
+
+	// pick up the new values of the active preset, unless the user is in the middle of editing it
+	const std::wstring & currentName = m_mouseParams.GetName();
+	if (!WereParametersChanged() && (std::find(changedNames.begin(), changedNames.end(), currentName) != changedNames.end()))
+	{
+		const std::vector<std::wstring> & allNames = optionsHolder.GetAllSettingNames();
+		if (std::find(allNames.begin(), allNames.end(), currentName) != allNames.end())
+		{
+			SetMouseParams(optionsHolder.GetSettings(currentName));
+		}
+		else if (!allNames.empty())
+		{
+			SetMouseParams(optionsHolder.GetSettings(allNames.front()));
+		}
+	}
+
+	return true;
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
 void
-MainSingleton::TriggerOverlay()
+MainSingleton::SetEmulationNotifier(const IEmulationNotifier::Ptr & notifier)
 {
-	if (emulationNotifier)
-	{
-		emulationNotifier->TriggerOverlay(GetMouseActioner().isEmulationActivated() && GetMouseParams().changeCursor);
-	}
+	engineContext.SetEmulationNotifier(notifier);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
 void
-MainSingleton::UpdateOverlay()
+MainSingleton::TriggerOverlay()
 {
-	if (emulationNotifier) emulationNotifier->UpdateOverlay();
+	engineContext.TriggerOverlay();
 }
 
 }}
\ No newline at end of file
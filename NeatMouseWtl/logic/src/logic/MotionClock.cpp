@@ -0,0 +1,53 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "logic/KeyboardUtils.h"
+#include "logic/MotionClock.h"
+
+namespace neatmouse {
+namespace logic {
+
+//=====================================================================================================================
+// SystemMotionClock
+//=====================================================================================================================
+
+//---------------------------------------------------------------------------------------------------------------------
+IMotionClock::TimePoint_t
+SystemMotionClock::Now()
+{
+	return std::chrono::steady_clock::now();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+SystemMotionClock::WaitUntil(std::condition_variable & condition, std::unique_lock<std::mutex> & lock, TimePoint_t deadline)
+{
+	return condition.wait_until(lock, deadline) == std::cv_status::timeout;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+IMotionClock::Duration_t
+SystemMotionClock::GetKeyboardInitialDelay()
+{
+	return std::chrono::milliseconds(KeyboardUtils::GetKeyboardInitialDelay());
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+IMotionClock::Duration_t
+SystemMotionClock::GetKeyboardRepeatPeriod()
+{
+	return std::chrono::milliseconds(KeyboardUtils::GetKeyboardRepeatPeriod());
+}
+
+}}
\ No newline at end of file
@@ -10,27 +10,63 @@
 #include "StdAfx.h"
 
 
-#include "logic/HookThread.h"
+#include "logic/EngineContext.h"
 #include "logic/KeyboardUtils.h"
-#include "logic/MainSingleton.h"
 #include "logic/MouseActioner.h"
 #include "logic/MouseUtils.h"
 
 namespace neatmouse {
 namespace logic {
 
+namespace {
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+GetTargetingDirection(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk, int & oHorizontal, int & oVertical)
+{
+	// the keys point at the cells the way they point the cursor: the middle button key stands for the center
+	const struct
+	{
+		KeyboardUtils::VirtualKey_t vk;
+		int horizontal;
+		int vertical;
+	} directions[] =
+	{
+		{ params.VKMoveLeftUp, -1, -1 }, { params.VKMoveUp, 0, -1 }, { params.VKMoveRightUp, 1, -1 },
+		{ params.VKMoveLeft, -1, 0 }, { params.VKPressMB, 0, 0 }, { params.VKMoveRight, 1, 0 },
+		{ params.VKMoveLeftDown, -1, 1 }, { params.VKMoveDown, 0, 1 }, { params.VKMoveRightDown, 1, 1 }
+	};
+
+	for (const auto & direction : directions)
+	{
+		if ((direction.vk != MouseParams::kVKNone) && (direction.vk == vk))
+		{
+			oHorizontal = direction.horizontal;
+			oVertical = direction.vertical;
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
-MouseActioner::MouseActioner()
+MouseActioner::MouseActioner(EngineContext & context) :
+	_context(context),
+	_rampUpCursorMover(context.GetMotionClock()),
+	_mouseParams(std::make_shared<const CompiledParams>(MouseParams()))
 {
-	// to ensure that overlay icon moves together with cursor when ramp-up movement is triggered
-	_rampUpCursorMover.setMoveCallback([](){ MainSingleton::Instance().UpdateOverlay(); });
+	// the ramp-up movement goes through the context too, so that the overlay icon moves together with the cursor
+	_rampUpCursorMover.setMoveCallback([this](LONG dx, LONG dy) { _context.MoveCursor(dx, dy); });
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
 MouseActioner::~MouseActioner(void)
 {
-	resetStickyButton();
+	releaseMouseButtons(*_mouseParams);
 }
 
 
@@ -57,12 +93,12 @@ MouseActioner::checkModifierButtonDown(int vk, int modifier, bool isKeyUp, bool
 
 //---------------------------------------------------------------------------------------------------------------------
 std::pair<KeyboardUtils::VirtualKey_t, bool>
-MouseActioner::preprocessKey(const KBDLLHOOKSTRUCT & event)
+MouseActioner::preprocessKey(const KeyEvent & event)
 {
-	KeyboardUtils::VirtualKey_t vk = static_cast<KeyboardUtils::VirtualKey_t>(event.vkCode);
-	KeyboardUtils::ScanCode_t sc = static_cast<KeyboardUtils::ScanCode_t>(event.scanCode);
+	KeyboardUtils::VirtualKey_t vk = event.vk;
+	KeyboardUtils::ScanCode_t sc = event.scanCode;
 
-	if ((event.flags & LLKHF_EXTENDED))
+	if (event.isExtended)
 	{
 		sc |= 0x100;
 		vk = -vk;
@@ -103,10 +139,16 @@ MouseActioner::preprocessKey(const KBDLLHOOKSTRUCT & event)
 
 //---------------------------------------------------------------------------------------------------------------------
 bool
-MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
+MouseActioner::processAction(const KeyEvent & event, bool isKeyUp)
 {
+	applyPendingMouseParams();
+
+	// the snapshot is kept alive until the event is processed, even if new parameters are published meanwhile
+	const std::shared_ptr<const CompiledParams> paramsSnapshot = getMouseParams();
+	const CompiledParams & params = *paramsSnapshot;
+
 	// ignore injected events
-	if (event.flags & LLKHF_INJECTED)
+	if (event.isInjected)
 	{
 		reset();
 		return false;
@@ -114,16 +156,16 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 
 	// if we're processing "Key Up" event and the key is our enabler (one of the locks), reset everything and return
 	if (isKeyUp &&
-	    (static_cast<logic::KeyboardUtils::VirtualKey_t>(event.vkCode) == _mouseParams.VKEnabler))
+	    (event.vk == params.VKEnabler))
 	{
-		_isEmulationActivated = (GetKeyState(_mouseParams.VKEnabler) & 1);
-		MainSingleton::Instance().NotifyEnabling(_isEmulationActivated);
+		_isEmulationActivated = (GetKeyState(params.VKEnabler) & 1);
+		_context.NotifyEnabling(_isEmulationActivated);
 		if (!_isEmulationActivated) reset();
 		return false;
 	}
 
 	// if emulation is not activated, reset and return
-	if (!isEmulationActivated())
+	if (!isEmulationActivated(params))
 	{
 		reset();
 		return false;
@@ -135,13 +177,13 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 	const bool isNumlockSpecialHandling = aKeyPair.second;
 
 	// if Activation Modifier has been set up, check whether is is pressed
-	if (_mouseParams.VKActivationMod != MouseParams::kVKNone)
+	if (params.VKActivationMod != MouseParams::kVKNone)
 	{
 		// if Activation Modifier has been pressed and it is the button we're currently processing, return true
 		// to block further event processing
-		if (checkModifierButtonDown(vk, _mouseParams.VKActivationMod, isKeyUp, isNumlockSpecialHandling, _isActivationButtonPressed))
+		if (checkModifierButtonDown(vk, params.VKActivationMod, isKeyUp, isNumlockSpecialHandling, _isActivationButtonPressed))
 		{
-			if (!_isActivationButtonPressed && (_mouseParams.VKActivationMod != VK_RSHIFT) && ((_mouseParams.VKActivationMod != VK_LSHIFT)))
+			if (!_isActivationButtonPressed && (params.VKActivationMod != VK_RSHIFT) && ((params.VKActivationMod != VK_LSHIFT)))
 			{
 				reset();
 			}
@@ -151,8 +193,8 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 		// if Activation Modifier is a Shift and we're working with the numerical keyboard, isNumlockSpecialHandling will indicate
 		// that Shift is pressed - there is no other way of deducing it here since Windows send Shift's Key Up in this case
 		if (isNumlockSpecialHandling &&
-		    ( ( (_mouseParams.VKActivationMod == VK_RSHIFT) && (_lastShift == LastShift_t::kRight) ) ||
-		      ( (_mouseParams.VKActivationMod == VK_LSHIFT) && (_lastShift == LastShift_t::kLeft) ) ) )
+		    ( ( (params.VKActivationMod == VK_RSHIFT) && (_lastShift == LastShift_t::kRight) ) ||
+		      ( (params.VKActivationMod == VK_LSHIFT) && (_lastShift == LastShift_t::kLeft) ) ) )
 		{
 			_isActivationButtonPressed = true;
 		}
@@ -171,13 +213,13 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 	}
 
 	// update the status of Alternative Speed Modifier; if we're currently processing its event, nothing more to do - exit
-	if (checkModifierButtonDown(vk, _mouseParams.VKAccelerated, isKeyUp, isNumlockSpecialHandling, _isAlternativeSpeedButtonPressed))
+	if (checkModifierButtonDown(vk, params.VKAccelerated, isKeyUp, isNumlockSpecialHandling, _isAlternativeSpeedButtonPressed))
 	{
 		return false;
 	}
 
 	// updade the status of Sticky Key Modifier and check if anything else should be done
-	if (checkModifierButtonDown(vk, _mouseParams.VKStickyKey, isKeyUp, isNumlockSpecialHandling, _isStickyButtonPressed))
+	if (checkModifierButtonDown(vk, params.VKStickyKey, isKeyUp, isNumlockSpecialHandling, _isStickyButtonPressed))
 	{
 		// Special processing of numerical keyboard and Shift modifiers:
 		// When a Shift key is pressed together with a key from a numerical keyboard, a Key Down even for Shift is sent twice.
@@ -193,7 +235,7 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 		{
 			if (_stickyButton != NMB_None)
 			{
-				resetStickyButton();
+				resetStickyButton(params);
 			}
 		}
 		return false;
@@ -204,17 +246,23 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 		// if checkModifierButtonDown() returned false, and both _isStickyButtonPressed and isNumlockSpecialHandling are true,
 		// this means that we're processing an event from the numerical keyboard with a Shift pressed; we want to ignore the
 		// next Shift Key Down event since it will be fake one generated by Windows
-		if (isNumlockSpecialHandling && _isStickyButtonPressed && (_mouseParams.VKStickyKey == VK_RSHIFT || _mouseParams.VKStickyKey == VK_LSHIFT))
+		if (isNumlockSpecialHandling && _isStickyButtonPressed && (params.VKStickyKey == VK_RSHIFT || params.VKStickyKey == VK_LSHIFT))
 		{
 			_ignoreNextStickyKeyDown = true;
 		}
 	}
 
+	// while the grid targeting is on, it takes the movement keys over
+	if (processTargetingKey(params, vk, isKeyUp))
+	{
+		return true;
+	}
+
 	const KeyboardButtonsStatus oldStatus = _keyboardStatus;
-	const bool result = isKeyUp ? processKeyUp(vk) : processKeyDown(vk);
+	const bool result = isKeyUp ? processKeyUp(params, vk) : processKeyDown(params, vk);
 
 	// figure out the movement vector
-	const LONG d = _isAlternativeSpeedButtonPressed ? _mouseParams.adelta : _mouseParams.delta;
+	const LONG d = _isAlternativeSpeedButtonPressed ? params.adelta : params.delta;
 	const LONG dx =
 		((_keyboardStatus.isLeftPressed || _keyboardStatus.isLeftUpPressed || _keyboardStatus.isLeftDownPressed) ? - d : 0) +
 		((_keyboardStatus.isRightPressed || _keyboardStatus.isRightUpPressed || _keyboardStatus.isRightDownPressed) ? d : 0);
@@ -247,14 +295,17 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 	    (_keyboardStatus.isLeftUpPressed && !oldStatus.isLeftUpPressed) ||
 	    (_keyboardStatus.isRightUpPressed && !oldStatus.isRightUpPressed))
 	{
-		if ((dx != 0) || (dy != 0)) _rampUpCursorMover.moveAsync(dx, dy);
+		if ((dx != 0) || (dy != 0))
+		{
+			EngineCounters::Increment(_context.GetCounters().rampStarts);
+			_rampUpCursorMover.moveAsync(dx, dy);
+		}
 	}
 	else
 	{
 		if ((dx != 0) || (dy != 0))
 		{
-			MouseUtils::MouseMove(dx, dy);
-			MainSingleton::Instance().UpdateOverlay();
+			_context.MoveCursor(dx, dy);
 		}
 	}
 	return result;
@@ -263,73 +314,73 @@ MouseActioner::processAction(const KBDLLHOOKSTRUCT & event, bool isKeyUp)
 
 //---------------------------------------------------------------------------------------------------------------------
 bool
-MouseActioner::processKeyUp(KeyboardUtils::VirtualKey_t vk)
+MouseActioner::processKeyUp(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk)
 {
-	if (vk == _mouseParams.VKMoveRight)
+	if (vk == params.VKMoveRight)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isRightPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveLeft)
+	if (vk == params.VKMoveLeft)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isLeftPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveUp)
+	if (vk == params.VKMoveUp)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isUpPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveDown)
+	if (vk == params.VKMoveDown)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isDownPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveLeftDown)
+	if (vk == params.VKMoveLeftDown)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isLeftDownPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveRightDown)
+	if (vk == params.VKMoveRightDown)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isRightDownPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveLeftUp)
+	if (vk == params.VKMoveLeftUp)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isLeftUpPressed = false;
 	} else
-	if (vk == _mouseParams.VKMoveRightUp)
+	if (vk == params.VKMoveRightUp)
 	{
 		_rampUpCursorMover.stopMove();
 		_keyboardStatus.isRightUpPressed = false;
 	}
 	else
 	// left button up -------------------------------------------------------
-	if ( (_stickyButton != NMB_Left) && (_mouseParams.VKPressLB == vk) )
+	if ( (_stickyButton != NMB_Left) && (params.VKPressLB == vk) )
 	{
 		if (_keyboardStatus.isLeftBtnPressed)
 		{
-			MouseUtils::MousePressLB(true);
+			_context.GetMouseOutput().MousePressLB(true);
 			_keyboardStatus.isLeftBtnPressed = false;
 		}
 	} else
 	// right button up ------------------------------------------------------
-	if ( (_stickyButton != NMB_Right) && (_mouseParams.VKPressRB == vk) )
+	if ( (_stickyButton != NMB_Right) && (params.VKPressRB == vk) )
 	{
 		if (_keyboardStatus.isRightBtnPressed)
 		{
-			MouseUtils::MousePressRB(true);
+			_context.GetMouseOutput().MousePressRB(true);
 			_keyboardStatus.isRightBtnPressed = false;
 		}
 	} else
 	// middle button up -----------------------------------------------------
-	if ( (_stickyButton != NMB_Middle) && (_mouseParams.VKPressMB == vk) )
+	if ( (_stickyButton != NMB_Middle) && (params.VKPressMB == vk) )
 	{
 		if (_keyboardStatus.isMiddleBtnPressed)
 		{
-			MouseUtils::MousePressMB(true);
+			_context.GetMouseOutput().MousePressMB(true);
 			_keyboardStatus.isMiddleBtnPressed = false;
 		}
 	} else
@@ -343,20 +394,20 @@ MouseActioner::processKeyUp(KeyboardUtils::VirtualKey_t vk)
 
 //---------------------------------------------------------------------------------------------------------------------
 bool
-MouseActioner::processKeyDown(KeyboardUtils::VirtualKey_t vk)
+MouseActioner::processKeyDown(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk)
 {
 	const bool isStickyModifierOn = _isStickyButtonPressed;
 
 	// left button down -----------------------------------------------------
-	if (_mouseParams.VKPressLB == vk)
+	if (params.VKPressLB == vk)
 	{
 		if (_stickyButton == NMB_Left)
 		{
-			resetStickyButton();
+			resetStickyButton(params);
 		} else
 		if (!_keyboardStatus.isLeftBtnPressed)
 		{
-			MouseUtils::MousePressLB(false);
+			_context.GetMouseOutput().MousePressLB(false);
 			_keyboardStatus.isLeftBtnPressed = true;
 			if (isStickyModifierOn)
 			{
@@ -365,15 +416,15 @@ MouseActioner::processKeyDown(KeyboardUtils::VirtualKey_t vk)
 		}
 	} else
 	// right button down -----------------------------------------------------
-	if (_mouseParams.VKPressRB == vk)
+	if (params.VKPressRB == vk)
 	{
 		if (_stickyButton == NMB_Right)
 		{
-			resetStickyButton();
+			resetStickyButton(params);
 		} else
 		if (!_keyboardStatus.isRightBtnPressed)
 		{
-			MouseUtils::MousePressRB(false);
+			_context.GetMouseOutput().MousePressRB(false);
 			_keyboardStatus.isRightBtnPressed = true;
 			if (isStickyModifierOn)
 			{
@@ -382,15 +433,15 @@ MouseActioner::processKeyDown(KeyboardUtils::VirtualKey_t vk)
 		}
 	} else
 	// middle button down ---------------------------------------------------
-	if (_mouseParams.VKPressMB == vk)
+	if (params.VKPressMB == vk)
 	{
 		if (_stickyButton == NMB_Middle)
 		{
-			resetStickyButton();
+			resetStickyButton(params);
 		} else
 		if (!_keyboardStatus.isMiddleBtnPressed)
 		{
-			MouseUtils::MousePressMB(false);
+			_context.GetMouseOutput().MousePressMB(false);
 			_keyboardStatus.isMiddleBtnPressed = true;
 			if (isStickyModifierOn)
 			{
@@ -399,55 +450,55 @@ MouseActioner::processKeyDown(KeyboardUtils::VirtualKey_t vk)
 		}
 	} else
 	// up -------------------------------------------------------------------
-	if (_mouseParams.VKMoveUp == vk)
+	if (params.VKMoveUp == vk)
 	{
 		_keyboardStatus.isUpPressed = true;
 	} else
 	// down -----------------------------------------------------------------
-	if (_mouseParams.VKMoveDown == vk)
+	if (params.VKMoveDown == vk)
 	{
 		_keyboardStatus.isDownPressed = true;
 	} else
 	// left -----------------------------------------------------------------
-	if (_mouseParams.VKMoveLeft == vk)
+	if (params.VKMoveLeft == vk)
 	{
 		_keyboardStatus.isLeftPressed = true;
 	} else
 	// right ----------------------------------------------------------------
-	if (_mouseParams.VKMoveRight == vk)
+	if (params.VKMoveRight == vk)
 	{
 		_keyboardStatus.isRightPressed = true;
 	} else
 	// left down ------------------------------------------------------------
-	if (_mouseParams.VKMoveLeftDown == vk)
+	if (params.VKMoveLeftDown == vk)
 	{
 		_keyboardStatus.isLeftDownPressed = true;
 	} else
 	// right down -----------------------------------------------------------
-	if (_mouseParams.VKMoveRightDown == vk)
+	if (params.VKMoveRightDown == vk)
 	{
 		_keyboardStatus.isRightDownPressed = true;
 	} else
 	// left up --------------------------------------------------------------
-	if (_mouseParams.VKMoveLeftUp == vk)
+	if (params.VKMoveLeftUp == vk)
 	{
 		_keyboardStatus.isLeftUpPressed = true;
 	} else
 	// right up -------------------------------------------------------------
-	if (_mouseParams.VKMoveRightUp == vk)
+	if (params.VKMoveRightUp == vk)
 	{
 		_keyboardStatus.isRightUpPressed = true;
 	}
 	else
 	// wheel up -------------------------------------------------------------
-	if (_mouseParams.VKWheelUp == vk)
+	if (params.VKWheelUp == vk)
 	{
-		MouseUtils::MouseWheel(false);
+		_context.GetMouseOutput().MouseWheel(false);
 	} else
 	// wheel down -----------------------------------------------------------
-	if (_mouseParams.VKWheelDown == vk)
+	if (params.VKWheelDown == vk)
 	{
-		MouseUtils::MouseWheel(true);
+		_context.GetMouseOutput().MouseWheel(true);
 	} else
 	{
 		return false;
@@ -457,35 +508,133 @@ MouseActioner::processKeyDown(KeyboardUtils::VirtualKey_t vk)
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+bool
+MouseActioner::processTargetingKey(const CompiledParams & params, KeyboardUtils::VirtualKey_t vk, bool isKeyUp)
+{
+	if (isKeyUp && (vk == _lastTargetingKey)) _lastTargetingKey = MouseParams::kVKNone;
+
+	// the targeting key is consumed in both directions, its Key Down having never reached the system
+	if ((params.VKTargeting != MouseParams::kVKNone) && (vk == params.VKTargeting))
+	{
+		if (!isKeyUp && (vk != _lastTargetingKey))
+		{
+			if (_gridTargeting.IsActive())
+			{
+				finishTargeting(true);
+			} else
+			{
+				startTargeting(params);
+			}
+			_lastTargetingKey = vk;
+		}
+		return true;
+	}
+
+	if (!_gridTargeting.IsActive()) return false;
+
+	int horizontal = 0;
+	int vertical = 0;
+	if (GetTargetingDirection(params, vk, horizontal, vertical))
+	{
+		if (!isKeyUp && (vk != _lastTargetingKey))
+		{
+			_lastTargetingKey = vk;
+			if (_gridTargeting.Narrow(horizontal, vertical))
+			{
+				if (_gridTargeting.CanNarrow())
+				{
+					_context.ShowTargetingGrid(_gridTargeting.GetRegion(), _gridTargeting.GetGridSize());
+				} else
+				{
+					finishTargeting(true);
+				}
+			}
+		}
+		return true;
+	}
+
+	if (isKeyUp) return false;
+
+	if (vk == VK_ESCAPE)
+	{
+		finishTargeting(false);
+		return true;
+	}
+
+	// the click happens at the target: the button key is processed further once the cursor is there
+	if ((vk == params.VKPressLB) || (vk == params.VKPressRB))
+	{
+		finishTargeting(true);
+	}
+	return false;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+MouseActioner::startTargeting(const CompiledParams & params)
+{
+	// the movement keys are taken over by the targeting; the buttons stay held, so that a drag may end at the target
+	_rampUpCursorMover.stopMove();
+	const KeyboardButtonsStatus oldStatus = _keyboardStatus;
+	_keyboardStatus = KeyboardButtonsStatus();
+	_keyboardStatus.isLeftBtnPressed = oldStatus.isLeftBtnPressed;
+	_keyboardStatus.isRightBtnPressed = oldStatus.isRightBtnPressed;
+	_keyboardStatus.isMiddleBtnPressed = oldStatus.isMiddleBtnPressed;
+	_keyboardStatus.isUnbindBtnPressed = oldStatus.isUnbindBtnPressed;
+
+	_gridTargeting.Start(MouseUtils::GetCursorMonitorRect(), params.targetingGridSize);
+	_context.ShowTargetingGrid(_gridTargeting.GetRegion(), _gridTargeting.GetGridSize());
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+MouseActioner::finishTargeting(bool moveCursor)
+{
+	_gridTargeting.Stop();
+	_context.HideTargetingGrid();
+	if (moveCursor)
+	{
+		const POINT target = _gridTargeting.GetTarget();
+		_context.MoveCursorTo(target.x, target.y);
+	}
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 void
 MouseActioner::activateEmulation(bool activate)
 {
-	if (_mouseParams.UseHotkey())
+	const std::shared_ptr<const CompiledParams> paramsSnapshot = getLatestMouseParams();
+	const CompiledParams & params = *paramsSnapshot;
+
+	if (params.UseHotkey())
 	{
 		_isEmulationActivated = activate;
 	} else
 	{
 		if (activate)
 		{
-			if (!(GetKeyState(_mouseParams.VKEnabler) & 1))
+			if (!(GetKeyState(params.VKEnabler) & 1))
 			{
-				keybd_event(static_cast<BYTE>(_mouseParams.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(_mouseParams.VKEnabler)), KEYEVENTF_EXTENDEDKEY, 0);
-				keybd_event(static_cast<BYTE>(_mouseParams.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(_mouseParams.VKEnabler)), KEYEVENTF_EXTENDEDKEY |  KEYEVENTF_KEYUP, 0);
+				keybd_event(static_cast<BYTE>(params.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(params.VKEnabler)), KEYEVENTF_EXTENDEDKEY, 0);
+				keybd_event(static_cast<BYTE>(params.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(params.VKEnabler)), KEYEVENTF_EXTENDEDKEY |  KEYEVENTF_KEYUP, 0);
 			}
 		} else
 		{
-			if (GetKeyState(_mouseParams.VKEnabler) & 1)
+			if (GetKeyState(params.VKEnabler) & 1)
 			{
-				keybd_event(static_cast<BYTE>(_mouseParams.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(_mouseParams.VKEnabler)), KEYEVENTF_EXTENDEDKEY, 0);
-				keybd_event(static_cast<BYTE>(_mouseParams.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(_mouseParams.VKEnabler)), KEYEVENTF_EXTENDEDKEY |  KEYEVENTF_KEYUP, 0);
+				keybd_event(static_cast<BYTE>(params.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(params.VKEnabler)), KEYEVENTF_EXTENDEDKEY, 0);
+				keybd_event(static_cast<BYTE>(params.VKEnabler), static_cast<BYTE>(KeyboardUtils::VirtualKeyToScanCode(params.VKEnabler)), KEYEVENTF_EXTENDEDKEY |  KEYEVENTF_KEYUP, 0);
 			}
 		}
 	}
 
 	if (!activate)
 	{
-		resetStickyButton();
+		resetStickyButton(params);
 		_isActivationButtonPressed = false;
 		_isAlternativeSpeedButtonPressed = false;
 	}
@@ -496,16 +645,24 @@ MouseActioner::activateEmulation(bool activate)
 bool
 MouseActioner::isEmulationActivated()
 {
-	if (_mouseParams.UseHotkey())
+	return isEmulationActivated(*getLatestMouseParams());
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+MouseActioner::isEmulationActivated(const CompiledParams & params) const
+{
+	if (params.UseHotkey())
 		return _isEmulationActivated;
 	else
-		return (GetKeyState(_mouseParams.VKEnabler) & 1);
+		return (GetKeyState(params.VKEnabler) & 1);
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
 void
-MouseActioner::resetStickyButton()
+MouseActioner::resetStickyButton(const CompiledParams & params)
 {
 	switch (_stickyButton)
 	{
@@ -513,39 +670,175 @@ MouseActioner::resetStickyButton()
 		break;
 	case NMB_Left:
 		_stickyButton = NMB_None;
-		processKeyUp(_mouseParams.VKPressLB);
+		processKeyUp(params, params.VKPressLB);
 		break;
 	case NMB_Middle:
 		_stickyButton = NMB_None;
-		processKeyUp(_mouseParams.VKPressMB);
+		processKeyUp(params, params.VKPressMB);
 		break;
 	case NMB_Right:
 		_stickyButton = NMB_None;
-		processKeyUp(_mouseParams.VKPressRB);
+		processKeyUp(params, params.VKPressRB);
 		break;
 	}
 	_stickyButton = NMB_None;
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+void
+MouseActioner::releaseMouseButtons(const CompiledParams & params)
+{
+	resetStickyButton(params);
+
+	if (_keyboardStatus.isLeftBtnPressed)
+	{
+		_context.GetMouseOutput().MousePressLB(true);
+		_keyboardStatus.isLeftBtnPressed = false;
+	}
+	if (_keyboardStatus.isRightBtnPressed)
+	{
+		_context.GetMouseOutput().MousePressRB(true);
+		_keyboardStatus.isRightBtnPressed = false;
+	}
+	if (_keyboardStatus.isMiddleBtnPressed)
+	{
+		_context.GetMouseOutput().MousePressMB(true);
+		_keyboardStatus.isMiddleBtnPressed = false;
+	}
+
+	assert(!isMouseButtonHeld());
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 void
 MouseActioner::reset()
 {
-	resetStickyButton();
+	// every event passed on while the emulation is off resets it, most of the times with nothing to drop
+	if (getStateMask() != 0) EngineCounters::Increment(_context.GetCounters().resets);
+
+	// a button held by its key (not in sticky mode) would stay pressed, since the key up event won't be processed
+	releaseMouseButtons(*getMouseParams());
 	_rampUpCursorMover.stopMove();
 	_keyboardStatus = KeyboardButtonsStatus();
 	_lastShift = LastShift_t::kUnknown;
 	_isActivationButtonPressed = false;
 	_isAlternativeSpeedButtonPressed = false;
 	_ignoreNextStickyKeyDown = false;
+	_lastTargetingKey = MouseParams::kVKNone;
+	if (_gridTargeting.IsActive()) finishTargeting(false);
+	applyPendingMouseParams();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 void
 MouseActioner::setMouseParams(const MouseParams& mouseParams)
 {
-	_mouseParams = mouseParams;
+	// the snapshot is built here, on the UI thread, so that the hook thread never copies the parameters; only the
+	// hook thread takes it into use, since only it knows whether a button is held
+	std::atomic_store(&_pendingMouseParams, std::make_shared<const CompiledParams>(mouseParams));
+	_hasPendingMouseParams = true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<const CompiledParams>
+MouseActioner::getMouseParams() const
+{
+	return std::atomic_load(&_mouseParams);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+MouseActioner::isKeyBound(const KeyEvent & event) const
+{
+	// only the hook thread replaces the snapshot, so it may use it without taking a reference
+	const CompiledParams & params = *_mouseParams;
+	return params.BindingExists(event.vk) || params.BindingExists(-event.vk);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<const CompiledParams>
+MouseActioner::getLatestMouseParams() const
+{
+	if (_hasPendingMouseParams)
+	{
+		std::shared_ptr<const CompiledParams> pending = std::atomic_load(&_pendingMouseParams);
+		if (pending) return pending;
+	}
+	return getMouseParams();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+MotionJitterStats
+MouseActioner::getMotionJitterStats()
+{
+	return _rampUpCursorMover.getJitterStats();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::uint16_t
+MouseActioner::getStateMask() const
+{
+	const bool bits[] =
+	{
+		_keyboardStatus.isLeftPressed, _keyboardStatus.isRightPressed, _keyboardStatus.isUpPressed, _keyboardStatus.isDownPressed,
+		_keyboardStatus.isLeftUpPressed, _keyboardStatus.isRightUpPressed, _keyboardStatus.isLeftDownPressed, _keyboardStatus.isRightDownPressed,
+		_keyboardStatus.isLeftBtnPressed, _keyboardStatus.isRightBtnPressed, _keyboardStatus.isMiddleBtnPressed,
+		_stickyButton != NMB_None,
+		_isActivationButtonPressed, _isAlternativeSpeedButtonPressed, _isStickyButtonPressed,
+		_gridTargeting.IsActive()
+	};
+
+	std::uint16_t mask = 0;
+	for (std::size_t i = 0; i < _countof(bits); ++i)
+	{
+		if (bits[i]) mask |= static_cast<std::uint16_t>(1u << i);
+	}
+	return mask;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+MouseActioner::setThreadScheduling(const ThreadSchedulingOptions & options)
+{
+	_rampUpCursorMover.setThreadScheduling(options);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+MouseActioner::isMouseButtonHeld() const
+{
+	return (_stickyButton != NMB_None) ||
+	       _keyboardStatus.isLeftBtnPressed ||
+	       _keyboardStatus.isRightBtnPressed ||
+	       _keyboardStatus.isMiddleBtnPressed;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+MouseActioner::applyPendingMouseParams()
+{
+	if (!_hasPendingMouseParams || isMouseButtonHeld()) return;
+
+	// the flag is cleared before taking the snapshot: a snapshot published in between raises it again, and is
+	// either taken right here or on the next call
+	_hasPendingMouseParams = false;
+	std::shared_ptr<const CompiledParams> pending = std::atomic_exchange(&_pendingMouseParams, std::shared_ptr<const CompiledParams>());
+	if (pending)
+	{
+		// the previous snapshot is released once the last reader holding it is done
+		std::atomic_store(&_mouseParams, std::move(pending));
+		EngineCounters::Increment(_context.GetCounters().paramSwaps);
+	}
 }
 
 }}
\ No newline at end of file
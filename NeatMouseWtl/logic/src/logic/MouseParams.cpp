@@ -62,6 +62,8 @@ bool MouseParams::Save(const std::wstring & fileName)
 	mif.writeIntValue(L"General", L"VK_PressMB", this->VKPressMB);
 	mif.writeIntValue(L"General", L"VK_WheelUp", this->VKWheelUp);
 	mif.writeIntValue(L"General", L"VK_WheelDown", this->VKWheelDown);
+	mif.writeIntValue(L"General", L"VK_Targeting", this->VKTargeting);
+	mif.writeIntValue(L"General", L"TargetingGridSize", this->targetingGridSize);
 
 	mif.writeUIntValue(L"General", L"VK_Hotkey", this->VKHotkey);
 	mif.writeUIntValue(L"General", L"ModHotkey", this->modHotkey);
@@ -109,6 +111,8 @@ bool MouseParams::Load(const std::wstring & fileName)
 	this->VKPressMB = mif.readIntValue(L"General", L"VK_PressMB", VK_NUMPAD5);
 	this->VKWheelUp = mif.readIntValue(L"General", L"VK_WheelUp", -VK_DIVIDE);
 	this->VKWheelDown = mif.readIntValue(L"General", L"VK_WheelDown", VK_MULTIPLY);
+	this->VKTargeting = mif.readIntValue(L"General", L"VK_Targeting", kVKNone);
+	this->targetingGridSize = mif.readIntValue(L"General", L"TargetingGridSize", 3);
 
 	this->VKHotkey = mif.readUIntValue(L"General", L"VK_Hotkey", VK_F10);
 	this->modHotkey = mif.readUIntValue(L"General", L"ModHotkey", MOD_CONTROL | MOD_ALT);
@@ -154,6 +158,8 @@ bool MouseParams::IsEqual(const MouseParams & mouseParams) const
 	if (VKPressMB != mouseParams.VKPressMB) return false;
 	if (VKWheelUp != mouseParams.VKWheelUp) return false;
 	if (VKWheelDown != mouseParams.VKWheelDown) return false;
+	if (VKTargeting != mouseParams.VKTargeting) return false;
+	if (targetingGridSize != mouseParams.targetingGridSize) return false;
 	if (minimizeOnStartup != mouseParams.minimizeOnStartup) return false;
 	if (activateOnStartup != mouseParams.activateOnStartup) return false;
 	if (changeCursor != mouseParams.changeCursor) return false;
@@ -182,7 +188,7 @@ MouseParams::MouseParams() : m_name(_T("[Untitled]"))
 
 
 //---------------------------------------------------------------------------------------------------------------------
-bool MouseParams::BindingExists(int keyCode)
+bool MouseParams::BindingExists(int keyCode) const
 {
 	if (VKEnabler == keyCode ||
 		VKMoveUp == keyCode ||
@@ -200,7 +206,8 @@ bool MouseParams::BindingExists(int keyCode)
 		VKPressRB == keyCode ||
 		VKPressMB == keyCode ||
 		VKWheelUp == keyCode ||
-		VKWheelDown == keyCode)
+		VKWheelDown == keyCode ||
+		VKTargeting == keyCode)
 		return true;
 
 	return false;
@@ -236,4 +243,64 @@ bool MouseParams::isModifierTaken(DWORD modifierId) const
 	return result;
 }
 
+
+//=====================================================================================================================
+// CompiledParams
+//=====================================================================================================================
+
+//---------------------------------------------------------------------------------------------------------------------
+CompiledParams::CompiledParams(const MouseParams & params) :
+	delta(params.delta),
+	adelta(params.adelta),
+	VKEnabler(params.VKEnabler),
+	VKMoveUp(params.VKMoveUp),
+	VKMoveDown(params.VKMoveDown),
+	VKMoveLeft(params.VKMoveLeft),
+	VKMoveRight(params.VKMoveRight),
+	VKMoveLeftUp(params.VKMoveLeftUp),
+	VKMoveRightUp(params.VKMoveRightUp),
+	VKMoveLeftDown(params.VKMoveLeftDown),
+	VKMoveRightDown(params.VKMoveRightDown),
+	VKAccelerated(params.VKAccelerated),
+	VKPressLB(params.VKPressLB),
+	VKPressRB(params.VKPressRB),
+	VKPressMB(params.VKPressMB),
+	VKWheelUp(params.VKWheelUp),
+	VKWheelDown(params.VKWheelDown),
+	VKActivationMod(params.VKActivationMod),
+	VKStickyKey(params.VKStickyKey),
+	VKTargeting(params.VKTargeting),
+	targetingGridSize(params.targetingGridSize),
+	useHotkey(params.UseHotkey()),
+	changeCursor(params.changeCursor),
+	showNotifications(params.showNotifications)
+{
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool CompiledParams::BindingExists(KeyboardUtils::VirtualKey_t keyCode) const
+{
+	if (keyCode == MouseParams::kVKNone) return false;
+
+	return VKEnabler == keyCode ||
+		VKMoveUp == keyCode ||
+		VKMoveDown == keyCode ||
+		VKMoveLeft == keyCode ||
+		VKMoveRight == keyCode ||
+		VKMoveLeftUp == keyCode ||
+		VKMoveRightDown == keyCode ||
+		VKMoveLeftDown == keyCode ||
+		VKMoveRightUp == keyCode ||
+		VKAccelerated == keyCode ||
+		VKActivationMod == keyCode ||
+		VKStickyKey == keyCode ||
+		VKPressLB == keyCode ||
+		VKPressRB == keyCode ||
+		VKPressMB == keyCode ||
+		VKWheelUp == keyCode ||
+		VKWheelDown == keyCode ||
+		VKTargeting == keyCode;
+}
+
 }}
\ No newline at end of file
@@ -31,6 +31,29 @@ void MouseUtils::MouseMove(LONG dx, LONG dy)
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+void MouseUtils::MouseMoveTo(LONG x, LONG y)
+{
+	// absolute coordinates are normalized to [0, 65535] over the whole virtual screen
+	const int left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+	const int top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+	const int width = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+	const int height = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+	MOUSEINPUT mouseInput;
+	mouseInput.dx = (width > 1) ? MulDiv(x - left, 65535, width - 1) : 0;
+	mouseInput.dy = (height > 1) ? MulDiv(y - top, 65535, height - 1) : 0;
+	mouseInput.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+	mouseInput.mouseData = 0;
+	mouseInput.time = 0;
+	mouseInput.dwExtraInfo = 0;
+	INPUT Input;
+	Input.type = INPUT_MOUSE;
+	Input.mi = mouseInput;
+	SendInput(1, &Input, sizeof(Input));
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 void MouseUtils::MousePressMB(bool doUp)
 {
@@ -89,4 +112,26 @@ void MouseUtils::MouseWheel(bool toUser)
 	SendInput(1, &Input, sizeof(Input));
 }
 
+
+//---------------------------------------------------------------------------------------------------------------------
+RECT MouseUtils::GetCursorMonitorRect()
+{
+	POINT pt = { 0, 0 };
+	GetCursorPos(&pt);
+
+	MONITORINFO monitorInfo;
+	monitorInfo.cbSize = sizeof(monitorInfo);
+	if (GetMonitorInfo(MonitorFromPoint(pt, MONITOR_DEFAULTTONEAREST), &monitorInfo))
+	{
+		return monitorInfo.rcMonitor;
+	}
+
+	RECT bounds;
+	bounds.left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+	bounds.top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+	bounds.right = bounds.left + GetSystemMetrics(SM_CXVIRTUALSCREEN);
+	bounds.bottom = bounds.top + GetSystemMetrics(SM_CYVIRTUALSCREEN);
+	return bounds;
+}
+
 }}
\ No newline at end of file
@@ -9,11 +9,58 @@
 
 #include "stdafx.h"
 
+#include <atomic>
+#include <thread>
+
 #include "logic/OptionsHolder.h"
 
 namespace neatmouse {
 namespace logic {
 
+namespace {
+
+// Loading presets from a network drive is dominated by the latency of opening the files rather than by the CPU,
+// so the number of loader threads is not tied to the number of cores
+constexpr std::size_t kMaxLoaderThreads = 8;
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Load the presets stored in the given files on a bounded pool of threads; the result follows the order of filePaths
+std::vector<MouseParams> LoadSettingsFiles(const std::vector<std::wstring> & filePaths)
+{
+	std::vector<MouseParams> result(filePaths.size());
+	std::atomic<std::size_t> nextIndex{ 0 };
+
+	const auto loader = [&filePaths, &result, &nextIndex]()
+	{
+		for (std::size_t i = nextIndex++; i < filePaths.size(); i = nextIndex++)
+		{
+			result[i].Load(filePaths[i]);
+		}
+	};
+
+	// the calling thread takes part in loading as well
+	const std::size_t threadCount = (filePaths.size() < kMaxLoaderThreads) ? filePaths.size() : kMaxLoaderThreads;
+	std::vector<std::thread> threads;
+	for (std::size_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(loader);
+	}
+	loader();
+	for (std::thread & t : threads) t.join();
+
+	return result;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool IsSameFile(const std::wstring & filePath1, const std::wstring & filePath2)
+{
+	return _wcsicmp(filePath1.c_str(), filePath2.c_str()) == 0;
+}
+
+}
+
 
 //---------------------------------------------------------------------------------------------------------------------
 void COptionsHolder::Load(const std::wstring & filePath)
@@ -65,6 +112,12 @@ void COptionsHolder::Load(const std::wstring & filePath)
 	m_defaultSettingsName = mif.readStringValue(L"General", L"dsn", L"");
 	m_lang = mif.readUtf8Value(L"General", L"lang", language);
 
+	const unsigned int priority = mif.readUIntValue(L"General", L"threadPriority", 0);
+	m_threadScheduling.priority = (priority <= static_cast<unsigned int>(ThreadSchedulingOptions::Priority_t::kTimeCritical)) ?
+		static_cast<ThreadSchedulingOptions::Priority_t>(priority) : ThreadSchedulingOptions::Priority_t::kDefault;
+	m_threadScheduling.useMmcss = mif.readBoolValue(L"General", L"threadMmcss", false);
+	m_threadScheduling.affinityMask = mif.readUIntValue(L"General", L"threadAffinity", 0);
+
 	LoadOptions();
 
 	// backward-compatibility loop to favor settings name over file name
@@ -101,6 +154,9 @@ void COptionsHolder::Save(const std::wstring & filePath)
 
 	mif.writeStringValue(L"General", L"dsn", m_defaultSettingsName);
 	mif.writeUtf8Value(L"General", L"lang", m_lang);
+	mif.writeUIntValue(L"General", L"threadPriority", static_cast<unsigned int>(m_threadScheduling.priority));
+	mif.writeBoolValue(L"General", L"threadMmcss", m_threadScheduling.useMmcss);
+	mif.writeUIntValue(L"General", L"threadAffinity", static_cast<unsigned int>(m_threadScheduling.affinityMask));
 
 	mif.save(filePath);
 	m_fileName = filePath;
@@ -173,11 +229,20 @@ void COptionsHolder::SetLanguageCode(const std::string & langCode)
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+const ThreadSchedulingOptions & COptionsHolder::GetThreadScheduling() const
+{
+	return m_threadScheduling;
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 void COptionsHolder::LoadOptions()
 {
 	m_settings.clear();
 
+	std::vector<std::wstring> filePaths;
+
 	WIN32_FIND_DATA fd;
 	HANDLE hFind = FindFirstFile((m_optionsFolder + L"\\*.nmp").c_str(), &fd);
 
@@ -187,15 +252,19 @@ void COptionsHolder::LoadOptions()
 	{
 		do
 		{
-			const std::wstring fn = m_optionsFolder + L"\\" + fd.cFileName;
-			MouseParams optsItem;
-			optsItem.Load(fn);
-			m_settings.emplace(optsItem.GetName(), optsItem);
+			filePaths.push_back(m_optionsFolder + L"\\" + fd.cFileName);
 		} while (FindNextFile(hFind, &fd));
 
 		FindClose(hFind);
 	}
 
+	// the files are parsed in parallel, but merged in the enumeration order: when several presets share a name,
+	// the first one found wins, just as it did when the files were loaded one by one
+	for (const MouseParams & optsItem : LoadSettingsFiles(filePaths))
+	{
+		m_settings.emplace(optsItem.GetName(), optsItem);
+	}
+
 	const std::wstring defaultSettingsPath = m_optionsFolder + L"\\default";
 	if (neatcommon::system::FileExists(defaultSettingsPath))
 	{
@@ -213,6 +282,58 @@ void COptionsHolder::LoadOptions()
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::wstring> COptionsHolder::ReloadSettingsFiles(const std::vector<std::wstring> & filePaths)
+{
+	std::vector<std::wstring> changedNames;
+
+	for (const std::wstring & filePath : filePaths)
+	{
+		if (IsSameFile(filePath, m_optionsFolder))
+		{
+			for (const auto & kv : m_settings) changedNames.push_back(kv.first);
+			LoadOptions();
+			for (const auto & kv : m_settings) changedNames.push_back(kv.first);
+			continue;
+		}
+
+		const std::wstring fileName = neatcommon::system::GetFileName(filePath);
+		const bool isPresetFile = (fileName.size() > 4) && IsSameFile(fileName.substr(fileName.size() - 4), L".nmp");
+		if (!isPresetFile && !IsSameFile(filePath, m_optionsFolder + L"\\default")) continue;
+
+		// forget whatever has been loaded from this file before
+		for (auto it = m_settings.begin(); it != m_settings.end(); )
+		{
+			if (IsSameFile(it->second.GetFilePath(), filePath))
+			{
+				changedNames.push_back(it->first);
+				it = m_settings.erase(it);
+			} else
+			{
+				++it;
+			}
+		}
+
+		// same as in LoadOptions(), a preset doesn't replace an already loaded one with the same name
+		MouseParams optsItem;
+		if (neatcommon::system::FileExists(filePath) && optsItem.Load(filePath))
+		{
+			if (m_settings.emplace(optsItem.GetName(), optsItem).second) changedNames.push_back(optsItem.GetName());
+		}
+	}
+
+	if (m_settings.empty())
+	{
+		LoadOptions();
+		for (const auto & kv : m_settings) changedNames.push_back(kv.first);
+	}
+
+	std::sort(changedNames.begin(), changedNames.end());
+	changedNames.erase(std::unique(changedNames.begin(), changedNames.end()), changedNames.end());
+	return changedNames;
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 MouseParams COptionsHolder::CreateNewSettings(const std::wstring & proposedName)
 {
@@ -9,46 +9,173 @@
 
 #include "stdafx.h"
 
-#include <thread>
-#include "logic/KeyboardUtils.h"
-#include "logic/MouseUtils.h"
 #include "logic/RampUpCursorMover.h"
 
 namespace neatmouse {
 namespace logic {
 
+//---------------------------------------------------------------------------------------------------------------------
+RampUpCursorMover::RampUpCursorMover(IMotionClock & clock) :
+	m_clock(clock),
+	m_thread(&RampUpCursorMover::motionThread, this)
+{
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+RampUpCursorMover::~RampUpCursorMover()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_quit = true;
+		++m_generation;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 void RampUpCursorMover::moveAsync(LONG dx, LONG dy)
 {
-	stopMove();
-	std::thread(std::ref(*this), dx, dy).detach();
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_requestGeneration = ++m_generation;
+		m_requestDx = dx;
+		m_requestDy = dy;
+		m_hasRequest = true;
+	}
+	m_condition.notify_all();
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
 void RampUpCursorMover::stopMove()
 {
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		++m_generation;
+	}
 	m_condition.notify_all();
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void RampUpCursorMover::operator() (LONG dx, LONG dy)
+void RampUpCursorMover::motionThread()
 {
-	const unsigned long kMinDelay = KeyboardUtils::GetKeyboardInitialDelay();
-	const unsigned long kTick = KeyboardUtils::GetKeyboardRepeatPeriod();
+	ScopedThreadScheduling scheduling{ ThreadSchedulingOptions() };
+
 	std::unique_lock<std::mutex> lk(m_mutex);
+	for (;;)
+	{
+		m_condition.wait(lk, [this] { return m_hasRequest || m_quit; });
+		if (m_quit) break;
+		m_hasRequest = false;
+
+		if (m_threadSchedulingChanged)
+		{
+			m_threadSchedulingChanged = false;
+			const ThreadSchedulingOptions options = m_threadScheduling;
+			lk.unlock();
+			scheduling.Apply(options);
+			lk.lock();
+		}
+
+		// a newer request or a stop may have come while the lock was released, the generation tells
+		move(m_requestDx, m_requestDy, m_requestGeneration, lk);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void RampUpCursorMover::move(LONG dx, LONG dy, unsigned long generation, std::unique_lock<std::mutex> & lk)
+{
+	const IMotionClock::Duration_t kMinDelay = m_clock.GetKeyboardInitialDelay();
+	const IMotionClock::Duration_t kTick = m_clock.GetKeyboardRepeatPeriod();
+	if (kTick <= IMotionClock::Duration_t::zero()) return;
+	const LONG kStepCount = static_cast<LONG>((kMinDelay + kTick - IMotionClock::Duration_t(1)) / kTick);
+
+	// the steps are due at absolute deadlines (start + n * tick), so that a late wake-up doesn't delay the next ones
+	const IMotionClock::TimePoint_t start = m_clock.Now();
+	LONG stepsDone = 0;
+	while ((stepsDone < kStepCount) && (generation == m_generation))
+	{
+		const IMotionClock::TimePoint_t now = m_clock.Now();
+		LONG stepsDue = static_cast<LONG>((now - start) / kTick) + 1;
+		if (stepsDue > kStepCount) stepsDue = kStepCount;
+
+		if (stepsDue > stepsDone)
+		{
+			// the missed steps are caught up by a longer move instead of a burst of moves
+			const LONG steps = stepsDue - stepsDone;
+			recordLateness(now - (start + stepsDone * kTick), steps);
+			stepsDone = stepsDue;
+
+			// the callback injects the move, which may take a while: the keyboard hook must be able to stop the
+			// move or request a new one meanwhile
+			if (m_moveCallback)
+			{
+				const LONG stepDx = dx * steps;
+				const LONG stepDy = dy * steps;
+				lk.unlock();
+				m_moveCallback(stepDx, stepDy);
+				lk.lock();
+				if (generation != m_generation) break;
+			}
+		}
+
+		// a notification means either a stop, checked above, or a spurious wake-up
+		if (stepsDone < kStepCount) m_clock.WaitUntil(m_condition, lk, start + stepsDone * kTick);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void RampUpCursorMover::recordLateness(IMotionClock::Duration_t lateness, LONG steps)
+{
+	const long long latenessUs = std::chrono::duration_cast<std::chrono::microseconds>(lateness).count();
+	std::size_t bucket = static_cast<std::size_t>(latenessUs / kLatenessBucketUs);
+	if (bucket >= kLatenessBucketCount) bucket = kLatenessBucketCount - 1;
+
+	++m_latenessHistogram[bucket];
+	m_latenessSumUs += latenessUs;
+	++m_ticks;
+	m_missedTicks += static_cast<unsigned long>(steps - 1);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void RampUpCursorMover::setThreadScheduling(const ThreadSchedulingOptions & options)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_threadScheduling = options;
+	m_threadSchedulingChanged = true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+MotionJitterStats RampUpCursorMover::getJitterStats()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+
+	MotionJitterStats stats{ m_ticks, m_missedTicks, 0.0, 0.0 };
+	if (m_ticks == 0) return stats;
+
+	stats.meanLatenessUs = static_cast<double>(m_latenessSumUs) / m_ticks;
 
-	const auto & waitTime = std::chrono::milliseconds(kTick);
-	for (unsigned long i = 0; i < kMinDelay; i += kTick)
+	// upper bound of the bucket containing the 99th percentile
+	const unsigned long rank = m_ticks - m_ticks / 100;
+	unsigned long count = 0;
+	for (std::size_t i = 0; i < kLatenessBucketCount; ++i)
 	{
-		MouseUtils::MouseMove(dx, dy);
-		if (m_moveCallback) m_moveCallback();
-		if (m_condition.wait_for(lk, waitTime) == std::cv_status::no_timeout)
+		count += m_latenessHistogram[i];
+		if (count >= rank)
 		{
+			stats.p99LatenessUs = static_cast<double>((i + 1) * kLatenessBucketUs);
 			break;
 		}
 	}
+	return stats;
 }
 
 
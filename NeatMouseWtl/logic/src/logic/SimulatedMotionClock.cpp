@@ -0,0 +1,112 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "logic/SimulatedMotionClock.h"
+
+namespace neatmouse {
+namespace logic {
+
+//---------------------------------------------------------------------------------------------------------------------
+SimulatedMotionClock::SimulatedMotionClock(Duration_t initialDelay, Duration_t repeatPeriod) :
+	m_initialDelay(initialDelay),
+	m_repeatPeriod(repeatPeriod)
+{
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+IMotionClock::TimePoint_t
+SimulatedMotionClock::Now()
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	return m_now;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+SimulatedMotionClock::WaitUntil(std::condition_variable & condition, std::unique_lock<std::mutex> & lock, TimePoint_t deadline)
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		if (m_now >= deadline) return true;
+		m_hasWaiter = true;
+		m_waiterDeadline = deadline;
+		m_waiterCondition = &condition;
+		m_waiterMutex = lock.mutex();
+	}
+	m_waiterChanged.notify_all();
+
+	// AdvanceTo() takes the mutex of the caller before notifying, so the wake-up can't come before the wait starts
+	condition.wait(lock);
+
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_hasWaiter = false;
+	return m_now >= deadline;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+IMotionClock::Duration_t
+SimulatedMotionClock::GetKeyboardInitialDelay()
+{
+	return m_initialDelay;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+IMotionClock::Duration_t
+SimulatedMotionClock::GetKeyboardRepeatPeriod()
+{
+	return m_repeatPeriod;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+SimulatedMotionClock::WaitForWaiter(std::chrono::milliseconds timeout, TimePoint_t & oDeadline)
+{
+	std::unique_lock<std::mutex> lk(m_mutex);
+	if (!m_waiterChanged.wait_for(lk, timeout, [this] { return m_hasWaiter; })) return false;
+	oDeadline = m_waiterDeadline;
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+SimulatedMotionClock::AdvanceTo(TimePoint_t time)
+{
+	std::condition_variable * condition = nullptr;
+	std::mutex * mutex = nullptr;
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		if (time > m_now) m_now = time;
+
+		// the waiter is forgotten at once, so that WaitForWaiter() only reports its next wait
+		if (m_hasWaiter && (m_now >= m_waiterDeadline))
+		{
+			m_hasWaiter = false;
+			condition = m_waiterCondition;
+			mutex = m_waiterMutex;
+		}
+	}
+
+	if (condition != nullptr)
+	{
+		{
+			std::lock_guard<std::mutex> lk(*mutex);
+		}
+		condition->notify_all();
+	}
+}
+
+}}
\ No newline at end of file
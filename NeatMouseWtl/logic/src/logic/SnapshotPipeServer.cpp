@@ -0,0 +1,213 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include <vector>
+
+#include "logic/SnapshotPipeServer.h"
+
+namespace neatmouse {
+namespace logic {
+
+namespace {
+
+/**
+ * Security attributes granting access to the current user only; the default DACL of a pipe lets everyone read it
+ */
+class CurrentUserSecurity
+{
+public:
+	CurrentUserSecurity()
+	{
+		HANDLE token = NULL;
+		if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token)) return;
+
+		DWORD size = 0;
+		GetTokenInformation(token, TokenUser, NULL, 0, &size);
+		m_tokenUser.resize(size);
+		const bool hasUser = (size > 0) && GetTokenInformation(token, TokenUser, m_tokenUser.data(), size, &size);
+		CloseHandle(token);
+		if (!hasUser) return;
+
+		const PSID sid = reinterpret_cast<const TOKEN_USER *>(m_tokenUser.data())->User.Sid;
+		m_acl.resize(sizeof(ACL) + sizeof(ACCESS_ALLOWED_ACE) + GetLengthSid(sid));
+		const PACL acl = reinterpret_cast<PACL>(m_acl.data());
+		if (!InitializeAcl(acl, static_cast<DWORD>(m_acl.size()), ACL_REVISION) ||
+		    !AddAccessAllowedAce(acl, ACL_REVISION, GENERIC_ALL, sid) ||
+		    !InitializeSecurityDescriptor(&m_descriptor, SECURITY_DESCRIPTOR_REVISION) ||
+		    !SetSecurityDescriptorDacl(&m_descriptor, TRUE, acl, FALSE))
+		{
+			return;
+		}
+
+		m_attributes.nLength = sizeof(m_attributes);
+		m_attributes.lpSecurityDescriptor = &m_descriptor;
+		m_attributes.bInheritHandle = FALSE;
+		m_isValid = true;
+	}
+
+	CurrentUserSecurity(const CurrentUserSecurity &) = delete;
+	CurrentUserSecurity & operator=(const CurrentUserSecurity &) = delete;
+
+	SECURITY_ATTRIBUTES * GetAttributes() { return m_isValid ? &m_attributes : nullptr; }
+
+private:
+	std::vector<BYTE> m_tokenUser;
+	std::vector<BYTE> m_acl;
+	SECURITY_DESCRIPTOR m_descriptor{};
+	SECURITY_ATTRIBUTES m_attributes{};
+	bool m_isValid = false;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+HANDLE CreatePipeInstance(const std::wstring & pipeName, SECURITY_ATTRIBUTES & security)
+{
+	constexpr DWORD kBufferSize = 4096;
+	// PIPE_REJECT_REMOTE_CLIENTS, which Windows XP doesn't know and rejects
+	constexpr DWORD kRejectRemoteClients = 0x00000008;
+
+	// the server has a single instance at a time, so that any other process owning the name is refused rather
+	// than taken for the server by the clients
+	constexpr DWORD kOpenMode = PIPE_ACCESS_OUTBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE;
+
+	HANDLE pipe = CreateNamedPipe(pipeName.c_str(), kOpenMode,
+		PIPE_TYPE_BYTE | PIPE_WAIT | kRejectRemoteClients, 1, kBufferSize, 0, 0, &security);
+	if ((pipe == INVALID_HANDLE_VALUE) && (GetLastError() == ERROR_INVALID_PARAMETER))
+	{
+		pipe = CreateNamedPipe(pipeName.c_str(), kOpenMode,
+			PIPE_TYPE_BYTE | PIPE_WAIT, 1, kBufferSize, 0, 0, &security);
+	}
+	return pipe;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Wait for an overlapped operation started on the pipe; false if it failed or the stop event was signalled first
+bool CompleteOverlapped(HANDLE pipe, OVERLAPPED & overlapped, HANDLE stopEvent)
+{
+	DWORD bytesTransferred = 0;
+	const HANDLE handles[2] = { stopEvent, overlapped.hEvent };
+	if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+	{
+		CancelIo(pipe);
+		GetOverlappedResult(pipe, &overlapped, &bytesTransferred, TRUE);
+		return false;
+	}
+	return GetOverlappedResult(pipe, &overlapped, &bytesTransferred, FALSE) != FALSE;
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+SnapshotPipeServer::~SnapshotPipeServer()
+{
+	Stop();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+SnapshotPipeServer::Start(const std::wstring & name, const SnapshotCallback_t & snapshot)
+{
+	Stop();
+
+	// one pipe per session, so that the instances running in different sessions don't collide
+	DWORD sessionId = 0;
+	ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+	m_pipeName = L"\\\\.\\pipe\\" + name + L"." + std::to_wstring(sessionId);
+
+	m_stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (m_stopEvent == NULL) return false;
+
+	m_snapshot = snapshot;
+	m_thread = std::thread(&SnapshotPipeServer::operator(), this);
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+SnapshotPipeServer::Stop()
+{
+	if (m_stopEvent) SetEvent(m_stopEvent);
+	if (m_thread.joinable()) m_thread.join();
+
+	if (m_stopEvent) CloseHandle(m_stopEvent);
+	m_stopEvent = NULL;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+SnapshotPipeServer::operator() ()
+{
+	// the snapshots may reveal what the user does, so the pipe is never served with the default security
+	CurrentUserSecurity security;
+	if (security.GetAttributes() == nullptr)
+	{
+		ATLTRACE(_T("Pipe security setup failed: %lu\n"), GetLastError());
+		return;
+	}
+
+	OVERLAPPED overlapped{};
+	overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (overlapped.hEvent == NULL) return;
+
+	while (WaitForSingleObject(m_stopEvent, 0) != WAIT_OBJECT_0)
+	{
+		const HANDLE pipe = CreatePipeInstance(m_pipeName, *security.GetAttributes());
+		if (pipe == INVALID_HANDLE_VALUE)
+		{
+			ATLTRACE(_T("Pipe creation failed: %lu\n"), GetLastError());
+			break;
+		}
+
+		bool isConnected = false;
+		ResetEvent(overlapped.hEvent);
+		if (ConnectNamedPipe(pipe, &overlapped))
+		{
+			isConnected = true;
+		} else
+		{
+			switch (GetLastError())
+			{
+			case ERROR_PIPE_CONNECTED:
+				isConnected = true;
+				break;
+			case ERROR_IO_PENDING:
+				isConnected = CompleteOverlapped(pipe, overlapped, m_stopEvent);
+				break;
+			default:
+				break;
+			}
+		}
+
+		if (isConnected)
+		{
+			const std::string snapshot = m_snapshot ? m_snapshot() : std::string();
+			ResetEvent(overlapped.hEvent);
+			if (!WriteFile(pipe, snapshot.data(), static_cast<DWORD>(snapshot.size()), NULL, &overlapped) &&
+			    (GetLastError() == ERROR_IO_PENDING))
+			{
+				CompleteOverlapped(pipe, overlapped, m_stopEvent);
+			}
+		}
+
+		// closing rather than disconnecting the pipe lets the client read what was written
+		CloseHandle(pipe);
+	}
+
+	CloseHandle(overlapped.hEvent);
+}
+
+
+}}
\ No newline at end of file
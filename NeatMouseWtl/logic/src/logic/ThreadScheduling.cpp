@@ -0,0 +1,117 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "logic/ThreadScheduling.h"
+
+namespace neatmouse {
+namespace logic {
+
+namespace {
+
+// avrt.dll doesn't exist on Windows XP, so it is never linked statically
+using AvSetMmThreadCharacteristics_t = HANDLE (WINAPI *)(LPCWSTR taskName, LPDWORD taskIndex);
+using AvRevertMmThreadCharacteristics_t = BOOL (WINAPI *)(HANDLE avrtHandle);
+
+struct AvrtFunctions
+{
+	AvSetMmThreadCharacteristics_t setCharacteristics = nullptr;
+	AvRevertMmThreadCharacteristics_t revertCharacteristics = nullptr;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+const AvrtFunctions & GetAvrtFunctions()
+{
+	static const AvrtFunctions functions = []()
+	{
+		AvrtFunctions result;
+		// never freed: the tasks may be reverted until the very end of the process
+		const HMODULE hAvrt = ::LoadLibrary(_T("avrt.dll"));
+		if (hAvrt != NULL)
+		{
+			result.setCharacteristics = reinterpret_cast<AvSetMmThreadCharacteristics_t>(::GetProcAddress(hAvrt, "AvSetMmThreadCharacteristicsW"));
+			result.revertCharacteristics = reinterpret_cast<AvRevertMmThreadCharacteristics_t>(::GetProcAddress(hAvrt, "AvRevertMmThreadCharacteristics"));
+		}
+		return result;
+	}();
+	return functions;
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+ScopedThreadScheduling::ScopedThreadScheduling(const ThreadSchedulingOptions & options)
+{
+	Apply(options);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+ScopedThreadScheduling::~ScopedThreadScheduling()
+{
+	RevertMmcss();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+ScopedThreadScheduling::Apply(const ThreadSchedulingOptions & options)
+{
+	const HANDLE hThread = ::GetCurrentThread();
+
+	switch (options.priority)
+	{
+	case ThreadSchedulingOptions::Priority_t::kHighest:
+		::SetThreadPriority(hThread, THREAD_PRIORITY_HIGHEST);
+		break;
+	case ThreadSchedulingOptions::Priority_t::kTimeCritical:
+		::SetThreadPriority(hThread, THREAD_PRIORITY_TIME_CRITICAL);
+		break;
+	default:
+		::SetThreadPriority(hThread, THREAD_PRIORITY_NORMAL);
+		break;
+	}
+
+	RevertMmcss();
+	if (options.useMmcss)
+	{
+		const AvrtFunctions & avrt = GetAvrtFunctions();
+		if (avrt.setCharacteristics != nullptr && avrt.revertCharacteristics != nullptr)
+		{
+			DWORD taskIndex = 0;
+			m_mmcssTask = avrt.setCharacteristics(L"Games", &taskIndex);
+		}
+	}
+
+	DWORD_PTR processMask = 0;
+	DWORD_PTR systemMask = 0;
+	if (::GetProcessAffinityMask(::GetCurrentProcess(), &processMask, &systemMask))
+	{
+		// no pinning, or a mask selecting none of the processors available to the process, means all of them
+		const DWORD_PTR mask = options.affinityMask & processMask;
+		::SetThreadAffinityMask(hThread, (mask != 0) ? mask : processMask);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+ScopedThreadScheduling::RevertMmcss()
+{
+	if (m_mmcssTask != NULL)
+	{
+		GetAvrtFunctions().revertCharacteristics(m_mmcssTask);
+		m_mmcssTask = NULL;
+	}
+}
+
+}}
\ No newline at end of file
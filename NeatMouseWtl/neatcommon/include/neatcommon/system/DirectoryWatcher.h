@@ -0,0 +1,49 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace neatcommon {
+namespace system {
+
+/**
+ * Watches a folder on a dedicated thread and reports the files which were touched there.
+ * Bursts of changes are debounced: the callback is invoked (on the watcher thread) once no
+ * further changes have been seen for the given period, with each touched file listed once.
+ */
+class DirectoryWatcher
+{
+public:
+	using ChangeCallback_t = std::function<void(const std::vector<std::wstring> & filePaths)>;
+
+	DirectoryWatcher() = default;
+	DirectoryWatcher(const DirectoryWatcher &) = delete;
+	DirectoryWatcher & operator=(const DirectoryWatcher &) = delete;
+	~DirectoryWatcher();
+
+	bool Start(const std::wstring & folderPath, unsigned long debounceMs, const ChangeCallback_t & callback);
+	void Stop();
+
+private:
+	void operator() ();
+
+	std::wstring m_folderPath;
+	unsigned long m_debounceMs = 0;
+	ChangeCallback_t m_callback;
+	HANDLE m_folderHandle = INVALID_HANDLE_VALUE;
+	HANDLE m_stopEvent = NULL;
+	std::thread m_thread;
+};
+
+}}
\ No newline at end of file
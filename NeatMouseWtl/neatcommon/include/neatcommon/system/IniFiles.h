@@ -13,6 +13,8 @@
 #include <string>
 #include <vector>
 
+#include "neatcommon/system/TextEncoding.h"
+
 namespace neatcommon {
 namespace system {
 
@@ -37,14 +39,19 @@ public:
 	const IniValueMap & getSection(const std::wstring & section);
 	void enumerateSections(std::vector<std::wstring> & sections);
 
-	bool save(const std::wstring & fileName);
+	/**
+	 * Files are written as UTF-16LE by default; both UTF-16LE and UTF-8 files are read,
+	 * the encoding being detected from the byte order mark.
+	 */
+	bool save(const std::wstring & fileName, TextEncoding encoding = TextEncoding::Utf16LE);
 	bool load(const std::wstring & fileName);
-	bool loadFromBuffer(const TCHAR * buffer);
+	bool loadFromBuffer(const unsigned char * buffer, std::size_t size);
 
 protected:
 	using IniSectionMap = std::map<std::wstring, std::map<std::wstring, std::wstring>>;
 	IniSectionMap values;
 	void parseLine(const std::wstring & line, std::wstring & currentSection);
+	void parseText(const std::wstring & text);
 };
 
 
@@ -0,0 +1,104 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "neatcommon/system/IniFiles.h"
+
+namespace neatcommon {
+namespace system {
+
+/**
+ * FNV-1a hash of a full localization key (ex. "main.lbl-speed"). Being constexpr, it lets keys written as string
+ * literals be hashed at compile time.
+ */
+constexpr std::uint32_t HashLocalizationKey(const char * key)
+{
+	std::uint32_t hash = 2166136261u;
+	while (*key != '\0')
+	{
+		hash ^= static_cast<unsigned char>(*key++);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+/**
+ * Binary locale pack. Packs are compiled from the .lng files at build time and used in place at run time, straight
+ * from the resource memory. A pack is laid out as follows (all integers are little-endian):
+ *
+ *   LocalePackHeader
+ *   LocalePackSlot[slotCount]  - open-addressing table of key hashes, linear probing, never more than half full
+ *   wchar_t[valuesSize]        - null-terminated UTF-16 translations
+ *   char[keysSize]             - null-terminated key names, used to detect hash collisions in debug builds
+ */
+struct LocalePackHeader
+{
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t slotCount;
+	std::uint32_t valuesSize;
+	std::uint32_t keysSize;
+};
+
+struct LocalePackSlot
+{
+	std::uint32_t hash;
+	std::uint32_t valueOffset;
+	std::uint32_t keyOffset;
+};
+
+
+/**
+ * Compile the translations read from a .lng file into a pack.
+ *
+ * @param iniFile   Loaded .lng file
+ * @param outData   Resulting pack
+ * @param outError  Description of the problem if the pack couldn't be built (ex. two keys having the same hash)
+ *
+ * @return  True if the pack was built
+ */
+bool BuildLocalePack(MyIniFile & iniFile, std::vector<unsigned char> & outData, std::string & outError);
+
+
+/**
+ * Read-only view of a pack. The memory the view is attached to must outlive it.
+ */
+class LocalePack
+{
+public:
+	/**
+	 * Attach the view to the pack stored in the given memory, after checking its structure
+	 */
+	bool Attach(const void * data, std::size_t size);
+	void Detach();
+
+	/**
+	 * Find the translation of a key
+	 *
+	 * @param keyHash  HashLocalizationKey() of the key
+	 * @param key      Key itself, used only by debug builds to check for hash collisions
+	 *
+	 * @return  The translation or nullptr if the key isn't in the pack
+	 */
+	const wchar_t * GetValue(std::uint32_t keyHash, const char * key) const;
+
+private:
+	const LocalePackSlot * m_slots = nullptr;
+	std::uint32_t m_slotCount = 0;
+	const wchar_t * m_values = nullptr;
+	const char * m_keys = nullptr;
+};
+
+}}
\ No newline at end of file
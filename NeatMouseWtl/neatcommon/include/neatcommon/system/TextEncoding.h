@@ -0,0 +1,41 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace neatcommon {
+namespace system {
+
+/**
+ * On-disk encodings of the text files. The bytes written for an encoding never depend on the
+ * width of wchar_t, so files stay interchangeable between 16-bit and 32-bit wchar_t platforms.
+ */
+enum class TextEncoding
+{
+	Utf16LE,
+	Utf8
+};
+
+/**
+ * Decodes a whole text file. The encoding is taken from the byte order mark; text without a BOM
+ * is treated as UTF-8. Malformed sequences are replaced with U+FFFD.
+ * @return the detected encoding
+ */
+TextEncoding DecodeText(const unsigned char * data, std::size_t size, std::wstring & outText);
+
+/**
+ * Encodes a whole text file, including the byte order mark of the given encoding.
+ */
+void EncodeText(const std::wstring & text, TextEncoding encoding, std::vector<unsigned char> & outData);
+
+}}
\ No newline at end of file
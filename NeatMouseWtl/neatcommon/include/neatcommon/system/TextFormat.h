@@ -0,0 +1,159 @@
+//
+// Copyright  20162020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cwchar>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace neatcommon {
+namespace system {
+
+//=====================================================================================================================
+// CFormatArg
+//=====================================================================================================================
+
+/**
+ * Argument of a format template. Integers are converted to text without any stream, strings are referenced rather
+ * than copied, so the referenced string must outlive the argument.
+ */
+class CFormatArg
+{
+public:
+	/// Enough for "-9223372036854775808"
+	static const std::size_t kMaxIntegerLength = 20;
+
+	CFormatArg(int value) : type(Type::Signed), signedValue(value) {}
+	CFormatArg(long value) : type(Type::Signed), signedValue(value) {}
+	CFormatArg(long long value) : type(Type::Signed), signedValue(value) {}
+	CFormatArg(unsigned int value) : type(Type::Unsigned), unsignedValue(value) {}
+	CFormatArg(unsigned long value) : type(Type::Unsigned), unsignedValue(value) {}
+	CFormatArg(unsigned long long value) : type(Type::Unsigned), unsignedValue(value) {}
+	CFormatArg(const wchar_t * value) : type(Type::String), text(value), length(std::wcslen(value)) {}
+	CFormatArg(const std::wstring & value) : type(Type::String), text(value.c_str()), length(value.size()) {}
+
+	// any other type (characters, bool, floating point...) has to be converted to a string by the caller
+	template <class T> CFormatArg(T) = delete;
+
+	/**
+	 * Text of the argument
+	 *
+	 * @param scratch    Buffer integers are written to
+	 * @param outLength  Length of the text
+	 *
+	 * @return  Pointer to the text, not null-terminated
+	 */
+	const wchar_t * GetText(wchar_t (&scratch)[kMaxIntegerLength], std::size_t & outLength) const;
+
+private:
+	enum class Type { Signed, Unsigned, String };
+
+	Type type;
+	long long signedValue = 0;
+	unsigned long long unsignedValue = 0;
+	const wchar_t * text = nullptr;
+	std::size_t length = 0;
+};
+
+
+//=====================================================================================================================
+// CFormatTemplate
+//=====================================================================================================================
+
+/**
+ * Format string with "%n%" placeholders (1-based, "%%" stands for the percent sign) parsed once. The format string is
+ * referenced rather than copied and must outlive the template.
+ */
+class CFormatTemplate
+{
+public:
+	explicit CFormatTemplate(const wchar_t * fmtString);
+
+	/**
+	 * Render the template into a caller-supplied buffer. The result is truncated to fit and always null-terminated.
+	 *
+	 * @return  Length of the result, without the terminating null
+	 */
+	std::size_t Render(wchar_t * buffer, std::size_t bufferSize, const CFormatArg * args, std::size_t argCount) const;
+
+	std::size_t Render(wchar_t * buffer, std::size_t bufferSize, std::initializer_list<CFormatArg> args) const
+	{
+		return Render(buffer, bufferSize, args.begin(), args.size());
+	}
+
+	template <std::size_t N>
+	const wchar_t * Render(wchar_t (&buffer)[N], std::initializer_list<CFormatArg> args) const
+	{
+		Render(buffer, N, args.begin(), args.size());
+		return buffer;
+	}
+
+	/**
+	 * Append the rendered template to a string, for results of unknown length
+	 */
+	void Append(std::wstring & outString, const CFormatArg * args, std::size_t argCount) const;
+
+private:
+	struct Segment
+	{
+		std::size_t offset;
+		std::size_t length;
+		std::size_t argNumber; ///< 1-based number of the argument, 0 for a piece of the format string itself
+	};
+
+	const wchar_t * fmtString;
+	std::vector<Segment> segments;
+};
+
+
+//=====================================================================================================================
+// CFormatter
+//=====================================================================================================================
+class CFormatter
+{
+public:
+	explicit CFormatter(const std::wstring & fmtString) : fmtString(fmtString) {}
+
+	template <class T>
+	CFormatter & operator % (const T & t)
+	{
+		addValue(t, std::is_constructible<CFormatArg, const T &>());
+		return *this;
+	}
+
+	std::wstring str() const;
+
+protected:
+	std::vector<std::wstring> values;
+	std::wstring fmtString;
+
+	template <class T>
+	void addValue(const T & t, std::true_type)
+	{
+		wchar_t scratch[CFormatArg::kMaxIntegerLength];
+		std::size_t length = 0;
+		const wchar_t * text = CFormatArg(t).GetText(scratch, length);
+		values.emplace_back(text, length);
+	}
+
+	template <class T>
+	void addValue(const T & t, std::false_type)
+	{
+		std::wstringstream s;
+		s << t;
+		values.push_back(s.str());
+	}
+};
+
+}}
\ No newline at end of file
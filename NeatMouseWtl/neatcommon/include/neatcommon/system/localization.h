@@ -10,74 +10,36 @@
 #pragma once
 
 #include "neatcommon/system/IniFiles.h"
+#include "neatcommon/system/LocalePack.h"
+#include "neatcommon/system/TextFormat.h"
+#include <cstdint>
 #include <memory>
 
 namespace neatcommon {
 namespace system {
 
-//=====================================================================================================================
-// CFormatter
-//=====================================================================================================================
-class CFormatter
-{
-public:
-	explicit CFormatter(const std::wstring & fmtString) : fmtString(fmtString) {}
-
-	template <class T>
-	CFormatter & operator % (const T & t)
-	{
-		std::wstringstream s;
-		s << t;
-		values.push_back(s.str());
-		return *this;
-	}
-
-	std::wstring str() const;
-
-protected:
-	std::vector<std::wstring> values;
-	std::wstring fmtString;
-};
-
-
-//=====================================================================================================================
-// LocalizeSection
-//=====================================================================================================================
-class LocalizeSection
-{
-public:
-	using Ptr = std::shared_ptr<LocalizeSection>;
-	LocalizeSection();
-	void Clear();
-	const std::wstring & GetValue(const std::string & value) const;
-	const Ptr GetSection(const std::string & section) const;
-	Ptr GetSection(const std::string & section);
-	Ptr AddSection(const std::string & name);
-	void SetValue(const std::string & name, const std::wstring & value);
-
-protected:
-	std::wstring defaultString;
-	std::map<std::string, std::wstring> values;
-	std::map<std::string, Ptr> sections;
-
-};
-
-
 //=====================================================================================================================
 // CLocalizer
 //=====================================================================================================================
+
+/**
+ * Translations of the selected language only. Packs embedded into the resources are used in place, straight from the
+ * resource memory; .lng files are compiled into a pack owned by the localizer when loaded.
+ */
 class CLocalizer
 {
 protected:
 	std::wstring defaultString;
-	LocalizeSection::Ptr section;
+	std::vector<unsigned char> ownedPack;
+	LocalePack pack;
+
 public:
 	CLocalizer();
-	void SetValue(const std::string & path, const std::wstring & value);
-	const std::wstring & GetValue(const std::string & path) const;
-	void loadFromIniFile(MyIniFile & iniFile);
-	void load(UINT resourceId, const std::wstring & iResourceType);
-	void load(const std::wstring & fileName);
+	const wchar_t * GetValue(std::uint32_t keyHash, const char * path) const;
+	const wchar_t * GetValue(const std::string & path) const;
+
+	bool load(UINT resourceId, const std::wstring & iResourceType);
+	bool load(const std::wstring & fileName);
 };
 
 
@@ -10,6 +10,11 @@
 #if !defined(_CUSTOMIZED_CONTROLS_H_)
 #define _CUSTOMIZED_CONTROLS_H_
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace neatcommon {
 namespace ui {
@@ -18,6 +23,14 @@ namespace ui {
 // functions
 //=====================================================================================================================
 HBITMAP AtlLoadGdiplusImage(ATL::_U_STRINGorID bitmap, ATL::_U_STRINGorID type);
+
+/**
+ * Decode a PNG resource into a top-down 32-bpp DIB section with premultiplied alpha, ready for AlphaBlend()
+ *
+ * @param id     Resource id
+ * @param scale  Scale of the image, in percent
+ */
+HBITMAP LoadPremultipliedPng(UINT id, UINT scale = 100);
 void DrawBitmapAdvanced(HDC pDC, CBitmapHandle bitmap, int x, int y, int w, int h, bool isDisabled = false);
 void SetMenuItemBitmapCallbackMode(CMenuHandle hmenu, UINT id, CBitmapHandle bitmap, BOOL byPosition = FALSE);
 
@@ -47,15 +60,52 @@ class CImageManager
 {
 public:
 	~CImageManager();
-	HBITMAP GetBitmapFromPng(UINT id);
+
+	/**
+	 * Get the bitmap of a PNG resource, decoding it if it hasn't been preloaded yet
+	 *
+	 * @param id     Resource id
+	 * @param scale  DPI scale, in percent
+	 */
+	HBITMAP GetBitmapFromPng(UINT id, UINT scale = 100);
+
+	/**
+	 * Start decoding all the PNG resources of the module on a background thread, so that the first paint
+	 * doesn't have to wait for GDI+
+	 */
+	void Preload(UINT scale = 100);
+
+	/**
+	 * Stop the preloading and wait for the background thread; must be called before GDI+ is shut down
+	 */
+	void StopPreload();
 
 protected:
-	std::map<UINT, HBITMAP> bitmaps;
+	struct Slot
+	{
+		HBITMAP bitmap = NULL;
+		bool loaded = false;
+	};
+
+	// one dense table of slots per scale, indexed by resource id
+	struct ScaledBitmaps
+	{
+		UINT scale;
+		std::vector<Slot> slots;
+	};
+
+	Slot & GetSlot(UINT id, UINT scale);
+	HBITMAP StoreBitmap(UINT id, UINT scale, HBITMAP bitmap);
+
+	std::mutex bitmapsMutex;
+	std::vector<ScaledBitmaps> bitmaps;
+	std::thread preloadThread;
+	std::atomic<bool> preloadStopped{ false };
 };
 
 
 //=====================================================================================================================
-// CImageManager
+// CMenuBitmapsManager
 //=====================================================================================================================
 class CMenuBitmapsManager
 {
@@ -67,8 +117,13 @@ public:
 	void Draw(LPDRAWITEMSTRUCT lpdis);
 
 protected:
-	std::map<UINT, CBitmapHandle> icons;
+	using Icon_t = std::pair<UINT, CBitmapHandle>;
+
+	// sorted by the menu item id
+	std::vector<Icon_t> icons;
 	CSize sz;
+
+	std::vector<Icon_t>::iterator FindIcon(UINT id);
 };
 
 
@@ -0,0 +1,157 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include "neatcommon/system/DirectoryWatcher.h"
+
+namespace neatcommon {
+namespace system {
+
+namespace {
+
+//---------------------------------------------------------------------------------------------------------------------
+// Collect the names of the files listed in a buffer filled by ReadDirectoryChangesW
+void CollectChangedFiles(const BYTE * buffer, const std::wstring & folderPath, std::vector<std::wstring> & oFiles)
+{
+	for (;;)
+	{
+		const FILE_NOTIFY_INFORMATION & info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(buffer);
+		const std::wstring fileName(info.FileName, info.FileNameLength / sizeof(WCHAR));
+		const std::wstring filePath = folderPath + L"\\" + fileName;
+
+		const auto it = std::find_if(oFiles.begin(), oFiles.end(),
+			[&filePath](const std::wstring & s) { return _wcsicmp(s.c_str(), filePath.c_str()) == 0; } );
+		if (it == oFiles.end()) oFiles.push_back(filePath);
+
+		if (info.NextEntryOffset == 0) break;
+		buffer += info.NextEntryOffset;
+	}
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+DirectoryWatcher::~DirectoryWatcher()
+{
+	Stop();
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+DirectoryWatcher::Start(const std::wstring & folderPath, unsigned long debounceMs, const ChangeCallback_t & callback)
+{
+	Stop();
+
+	m_folderHandle = CreateFile(folderPath.c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (m_folderHandle == INVALID_HANDLE_VALUE) return false;
+
+	m_stopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (m_stopEvent == NULL)
+	{
+		CloseHandle(m_folderHandle);
+		m_folderHandle = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	m_folderPath = folderPath;
+	m_debounceMs = debounceMs;
+	m_callback = callback;
+	m_thread = std::thread(&DirectoryWatcher::operator(), this);
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+DirectoryWatcher::Stop()
+{
+	if (m_stopEvent) SetEvent(m_stopEvent);
+	if (m_thread.joinable()) m_thread.join();
+
+	if (m_stopEvent) CloseHandle(m_stopEvent);
+	if (m_folderHandle != INVALID_HANDLE_VALUE) CloseHandle(m_folderHandle);
+
+	m_stopEvent = NULL;
+	m_folderHandle = INVALID_HANDLE_VALUE;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+DirectoryWatcher::operator() ()
+{
+	constexpr DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+	// FILE_NOTIFY_INFORMATION entries must be DWORD-aligned
+	std::vector<DWORD> buffer(16 * 1024);
+	const DWORD bufferSize = static_cast<DWORD>(buffer.size() * sizeof(DWORD));
+
+	OVERLAPPED overlapped{};
+	overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (overlapped.hEvent == NULL) return;
+
+	std::vector<std::wstring> changedFiles;
+	bool isReadPending = false;
+
+	for (;;)
+	{
+		if (!isReadPending)
+		{
+			ResetEvent(overlapped.hEvent);
+			if (!ReadDirectoryChangesW(m_folderHandle, buffer.data(), bufferSize, FALSE, kNotifyFilter, NULL, &overlapped, NULL))
+			{
+				break;
+			}
+			isReadPending = true;
+		}
+
+		// while a burst of changes is being collected, wait only for the debounce period
+		const HANDLE handles[2] = { m_stopEvent, overlapped.hEvent };
+		const DWORD waitResult = WaitForMultipleObjects(2, handles, FALSE, changedFiles.empty() ? INFINITE : m_debounceMs);
+
+		if (waitResult == WAIT_OBJECT_0 + 1)
+		{
+			isReadPending = false;
+			DWORD bytesReturned = 0;
+			if (!GetOverlappedResult(m_folderHandle, &overlapped, &bytesReturned, FALSE)) break;
+
+			if (bytesReturned > 0)
+			{
+				CollectChangedFiles(reinterpret_cast<const BYTE *>(buffer.data()), m_folderPath, changedFiles);
+			} else
+			{
+				// the buffer overflowed and the details are lost: report the folder itself
+				changedFiles.push_back(m_folderPath);
+			}
+		} else
+		if (waitResult == WAIT_TIMEOUT)
+		{
+			if (m_callback) m_callback(changedFiles);
+			changedFiles.clear();
+		} else
+		{
+			break;
+		}
+	}
+
+	if (isReadPending)
+	{
+		CancelIo(m_folderHandle);
+		DWORD bytesReturned = 0;
+		GetOverlappedResult(m_folderHandle, &overlapped, &bytesReturned, TRUE);
+	}
+	CloseHandle(overlapped.hEvent);
+}
+
+}}
\ No newline at end of file
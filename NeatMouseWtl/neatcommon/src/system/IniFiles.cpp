@@ -165,29 +165,27 @@ MyIniFile::readIntValue(const std::wstring & section, const std::wstring & name,
 
 //---------------------------------------------------------------------------------------------------------------------
 bool 
-MyIniFile::save(const std::wstring & fileName)
+MyIniFile::save(const std::wstring & fileName, TextEncoding encoding)
 {
-	static const unsigned char BOM[2] = { 0xFF, 0xFE };
-	FILE * fileHandle;
-	if (_wfopen_s( &fileHandle, fileName.c_str(), L"wb" )) return false;
-	if (fileHandle == NULL) return false;
-	fwrite(BOM, sizeof(char), 2, fileHandle);
-	for (const IniSectionMap::value_type aSection : values)
+	std::wstring text;
+	for (const IniSectionMap::value_type & aSection : values)
 	{
-		std::wstring s = L'[' + aSection.first + L"]\n";
-		const wchar_t * t = s.c_str();
-		std::size_t strSize = wcslen(t);
-		if (fwrite(t, sizeof(wchar_t), strSize, fileHandle) != strSize) return false;
-		for (const IniValueMap::value_type aValue : aSection.second)
+		text += L'[' + aSection.first + L"]\n";
+		for (const IniValueMap::value_type & aValue : aSection.second)
 		{
-			s = aValue.first + L'=' + aValue.second + L'\n';
-			t = s.c_str();
-			strSize = wcslen(t);
-			if (fwrite(t, sizeof(wchar_t), strSize, fileHandle) != strSize) return false;
+			text += aValue.first + L'=' + aValue.second + L'\n';
 		}
 	}
+
+	std::vector<unsigned char> data;
+	EncodeText(text, encoding, data);
+
+	FILE * fileHandle;
+	if (_wfopen_s( &fileHandle, fileName.c_str(), L"wb" )) return false;
+	if (fileHandle == NULL) return false;
+	const bool res = fwrite(data.data(), sizeof(unsigned char), data.size(), fileHandle) == data.size();
 	fclose(fileHandle);
-	return true;
+	return res;
 }
 
 
@@ -236,20 +234,29 @@ MyIniFile::parseLine(const std::wstring & line, std::wstring & currentSection)
 
 
 //---------------------------------------------------------------------------------------------------------------------
-bool
-MyIniFile::loadFromBuffer(const TCHAR * iBuffer)
+void
+MyIniFile::parseText(const std::wstring & text)
 {
-	const TCHAR *buffer = (TCHAR*)((char*)iBuffer + 2);
 	values.clear();
-	std::wstring currentSection = L"";
-	wchar_t line[1025];
-	std::wstringstream w(buffer);
-	
-	while (!w.eof())
+	std::wstring currentSection;
+	std::size_t lineStart = 0;
+	while (lineStart < text.size())
 	{
-		w.getline(line, 1024);
-		parseLine(line, currentSection);
+		std::size_t lineEnd = text.find(L'\n', lineStart);
+		if (lineEnd == std::wstring::npos) lineEnd = text.size();
+		parseLine(text.substr(lineStart, lineEnd - lineStart), currentSection);
+		lineStart = lineEnd + 1;
 	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+MyIniFile::loadFromBuffer(const unsigned char * buffer, std::size_t size)
+{
+	std::wstring text;
+	DecodeText(buffer, size, text);
+	parseText(text);
 	return true;
 }
 
@@ -260,24 +267,19 @@ MyIniFile::load(const std::wstring & fileName)
 {
 	values.clear();
 	FILE * fileHandle;
-
-	char BOM[2];
 	if (_wfopen_s( &fileHandle, fileName.c_str(), L"rb" ))
 		return false;
-	wchar_t line[1025];
-
-	fread(BOM, sizeof(char), 2, fileHandle);
-
-	std::wstring currentSection;
 
-	while (fgetws(line, 1024, fileHandle))
+	std::vector<unsigned char> data;
+	unsigned char chunk[16 * 1024];
+	std::size_t bytesRead = 0;
+	while ((bytesRead = fread(chunk, sizeof(unsigned char), sizeof(chunk), fileHandle)) > 0)
 	{
-		parseLine(line, currentSection);
+		data.insert(data.end(), chunk, chunk + bytesRead);
 	}
-
 	fclose(fileHandle);
 
-	return true;
+	return loadFromBuffer(data.data(), data.size());
 }
 
 }}
\ No newline at end of file
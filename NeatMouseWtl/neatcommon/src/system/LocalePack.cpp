@@ -0,0 +1,201 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#include "neatcommon/system/LocalePack.h"
+
+namespace neatcommon {
+namespace system {
+
+static_assert(sizeof(wchar_t) == 2, "locale packs are used in place and store UTF-16 strings");
+static_assert(sizeof(LocalePackHeader) == 5 * sizeof(std::uint32_t), "unexpected padding in LocalePackHeader");
+static_assert(sizeof(LocalePackSlot) == 3 * sizeof(std::uint32_t), "unexpected padding in LocalePackSlot");
+
+namespace {
+
+const std::uint32_t kLocalePackMagic = 0x504C4D4E; // "NMLP"
+const std::uint32_t kLocalePackVersion = 1;
+const std::uint32_t kEmptySlot = 0xFFFFFFFF;
+const std::size_t kMinSlotCount = 16;
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void AppendUInt32(std::uint32_t value, std::vector<unsigned char> & outData)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		outData.push_back(static_cast<unsigned char>((value >> (8 * i)) & 0xFF));
+	}
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+BuildLocalePack(MyIniFile & iniFile, std::vector<unsigned char> & outData, std::string & outError)
+{
+	std::vector<LocalePackSlot> entries;
+	std::wstring values;
+	std::string keys;
+	std::unordered_map<std::uint32_t, std::string> keyNames;
+
+	std::vector<std::wstring> sections;
+	iniFile.enumerateSections(sections);
+	for (const std::wstring & s : sections)
+	{
+		for (const auto & aValue : iniFile.getSection(s))
+		{
+			std::string key;
+			wstring2string(s + L"." + aValue.first, key);
+			const std::uint32_t keyHash = HashLocalizationKey(key.c_str());
+
+			const auto res = keyNames.emplace(keyHash, key);
+			if (!res.second)
+			{
+				if (res.first->second != key)
+				{
+					outError = "keys '" + res.first->second + "' and '" + key + "' have the same hash";
+					return false;
+				}
+				// the first value of a key wins
+				continue;
+			}
+
+			entries.push_back(LocalePackSlot{ keyHash, static_cast<std::uint32_t>(values.size()), static_cast<std::uint32_t>(keys.size()) });
+			values.append(aValue.second);
+			values.push_back(L'\0');
+			keys.append(key);
+			keys.push_back('\0');
+		}
+	}
+
+	std::size_t slotCount = kMinSlotCount;
+	while (slotCount < 2 * entries.size()) slotCount *= 2;
+
+	std::vector<LocalePackSlot> slots(slotCount, LocalePackSlot{ 0, kEmptySlot, kEmptySlot });
+	const std::size_t mask = slotCount - 1;
+	for (const LocalePackSlot & entry : entries)
+	{
+		std::size_t i = entry.hash & mask;
+		while (slots[i].valueOffset != kEmptySlot) i = (i + 1) & mask;
+		slots[i] = entry;
+	}
+
+	outData.clear();
+	outData.reserve(sizeof(LocalePackHeader) + slotCount * sizeof(LocalePackSlot) + values.size() * 2 + keys.size());
+	AppendUInt32(kLocalePackMagic, outData);
+	AppendUInt32(kLocalePackVersion, outData);
+	AppendUInt32(static_cast<std::uint32_t>(slotCount), outData);
+	AppendUInt32(static_cast<std::uint32_t>(values.size()), outData);
+	AppendUInt32(static_cast<std::uint32_t>(keys.size()), outData);
+	for (const LocalePackSlot & slot : slots)
+	{
+		AppendUInt32(slot.hash, outData);
+		AppendUInt32(slot.valueOffset, outData);
+		AppendUInt32(slot.keyOffset, outData);
+	}
+	for (const wchar_t c : values)
+	{
+		outData.push_back(static_cast<unsigned char>(c & 0xFF));
+		outData.push_back(static_cast<unsigned char>((c >> 8) & 0xFF));
+	}
+	outData.insert(outData.end(), keys.begin(), keys.end());
+	return true;
+}
+
+
+
+//=====================================================================================================================
+// LocalePack
+//=====================================================================================================================
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+LocalePack::Attach(const void * data, std::size_t size)
+{
+	Detach();
+
+	if (data == nullptr || size < sizeof(LocalePackHeader)) return false;
+	if (reinterpret_cast<std::uintptr_t>(data) % alignof(LocalePackSlot) != 0) return false;
+
+	LocalePackHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != kLocalePackMagic || header.version != kLocalePackVersion) return false;
+	if (header.slotCount < kMinSlotCount || (header.slotCount & (header.slotCount - 1)) != 0) return false;
+
+	const std::size_t slotsSize = static_cast<std::size_t>(header.slotCount) * sizeof(LocalePackSlot);
+	const std::size_t valuesSize = static_cast<std::size_t>(header.valuesSize) * sizeof(wchar_t);
+	if (size != sizeof(LocalePackHeader) + slotsSize + valuesSize + header.keysSize) return false;
+
+	const unsigned char * bytes = static_cast<const unsigned char *>(data);
+	const LocalePackSlot * slots = reinterpret_cast<const LocalePackSlot *>(bytes + sizeof(LocalePackHeader));
+	const wchar_t * values = reinterpret_cast<const wchar_t *>(bytes + sizeof(LocalePackHeader) + slotsSize);
+	const char * keys = reinterpret_cast<const char *>(bytes + sizeof(LocalePackHeader) + slotsSize + valuesSize);
+
+	// every string must be terminated inside its arena, and at least one slot must be empty to stop the probing
+	if (header.valuesSize > 0 && values[header.valuesSize - 1] != L'\0') return false;
+	if (header.keysSize > 0 && keys[header.keysSize - 1] != '\0') return false;
+	bool hasEmptySlot = false;
+	for (std::uint32_t i = 0; i < header.slotCount; ++i)
+	{
+		if (slots[i].valueOffset == kEmptySlot)
+		{
+			hasEmptySlot = true;
+		} else
+		if (slots[i].valueOffset >= header.valuesSize || slots[i].keyOffset >= header.keysSize)
+		{
+			return false;
+		}
+	}
+	if (!hasEmptySlot) return false;
+
+	m_slots = slots;
+	m_slotCount = header.slotCount;
+	m_values = values;
+	m_keys = keys;
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+LocalePack::Detach()
+{
+	m_slots = nullptr;
+	m_slotCount = 0;
+	m_values = nullptr;
+	m_keys = nullptr;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+const wchar_t *
+LocalePack::GetValue(std::uint32_t keyHash, const char * key) const
+{
+	if (m_slotCount == 0) return nullptr;
+
+	const std::uint32_t mask = m_slotCount - 1;
+	for (std::uint32_t i = keyHash & mask; m_slots[i].valueOffset != kEmptySlot; i = (i + 1) & mask)
+	{
+		if (m_slots[i].hash == keyHash)
+		{
+			// two different keys having the same hash would silently share a translation
+			ASSERT(std::strcmp(m_keys + m_slots[i].keyOffset, key) == 0);
+			return m_values + m_slots[i].valueOffset;
+		}
+	}
+	return nullptr;
+}
+
+}}
\ No newline at end of file
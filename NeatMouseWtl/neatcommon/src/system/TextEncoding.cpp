@@ -0,0 +1,284 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "neatcommon/system/TextEncoding.h"
+
+
+namespace neatcommon {
+namespace system {
+
+namespace {
+
+const unsigned char kUtf16LEBom[] = { 0xFF, 0xFE };
+const unsigned char kUtf8Bom[] = { 0xEF, 0xBB, 0xBF };
+
+constexpr char32_t kReplacementChar = 0xFFFD;
+constexpr bool kIsWideCharUtf16 = sizeof(wchar_t) == 2;
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Number of leading bytes below 0x80, checked eight bytes at a time
+std::size_t CountAsciiBytes(const unsigned char * data, std::size_t size)
+{
+	std::size_t i = 0;
+	for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+	{
+		std::uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+		if (word & 0x8080808080808080ULL) break;
+	}
+	while (i < size && data[i] < 0x80) ++i;
+	return i;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Number of leading characters below 0x80
+std::size_t CountAsciiChars(const wchar_t * text, std::size_t size)
+{
+	std::size_t i = 0;
+	while (i < size && static_cast<std::uint32_t>(text[i]) < 0x80) ++i;
+	return i;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool IsHighSurrogate(char32_t c) { return c >= 0xD800 && c <= 0xDBFF; }
+bool IsLowSurrogate(char32_t c) { return c >= 0xDC00 && c <= 0xDFFF; }
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void AppendCodePoint(char32_t codePoint, std::wstring & outText)
+{
+	if (kIsWideCharUtf16 && codePoint > 0xFFFF)
+	{
+		codePoint -= 0x10000;
+		outText.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+		outText.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+	} else
+	{
+		outText.push_back(static_cast<wchar_t>(codePoint));
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Reads one code point from the text, combining surrogate pairs when wchar_t is UTF-16
+char32_t ReadCodePoint(const wchar_t * text, std::size_t size, std::size_t & pos)
+{
+	const char32_t c = static_cast<std::uint32_t>(text[pos++]);
+	if (kIsWideCharUtf16 && IsHighSurrogate(c))
+	{
+		if (pos < size && IsLowSurrogate(static_cast<std::uint32_t>(text[pos])))
+		{
+			const char32_t low = static_cast<std::uint32_t>(text[pos++]);
+			return 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+		}
+		return kReplacementChar;
+	}
+	if (IsLowSurrogate(c) || c > 0x10FFFF) return kReplacementChar;
+	return c;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void DecodeUtf8(const unsigned char * data, std::size_t size, std::wstring & outText)
+{
+	outText.reserve(outText.size() + size);
+	std::size_t i = 0;
+	while (i < size)
+	{
+		const std::size_t asciiCount = CountAsciiBytes(data + i, size - i);
+		outText.append(data + i, data + i + asciiCount);
+		i += asciiCount;
+		if (i == size) break;
+
+		const unsigned char lead = data[i];
+		std::size_t length = 0;
+		char32_t codePoint = 0;
+		char32_t minCodePoint = 0;
+		if ((lead & 0xE0) == 0xC0) { length = 2; codePoint = lead & 0x1F; minCodePoint = 0x80; } else
+		if ((lead & 0xF0) == 0xE0) { length = 3; codePoint = lead & 0x0F; minCodePoint = 0x800; } else
+		if ((lead & 0xF8) == 0xF0) { length = 4; codePoint = lead & 0x07; minCodePoint = 0x10000; }
+
+		std::size_t consumed = 1;
+		while (length > 0 && consumed < length && i + consumed < size && (data[i + consumed] & 0xC0) == 0x80)
+		{
+			codePoint = (codePoint << 6) | (data[i + consumed] & 0x3F);
+			++consumed;
+		}
+
+		if (length == 0 || consumed < length || codePoint < minCodePoint || codePoint > 0x10FFFF ||
+		    IsHighSurrogate(codePoint) || IsLowSurrogate(codePoint))
+		{
+			AppendCodePoint(kReplacementChar, outText);
+		} else
+		{
+			AppendCodePoint(codePoint, outText);
+		}
+		i += consumed;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void DecodeUtf16LE(const unsigned char * data, std::size_t size, std::wstring & outText)
+{
+	const std::size_t unitCount = size / 2;
+	if (kIsWideCharUtf16)
+	{
+		const std::size_t offset = outText.size();
+		outText.resize(offset + unitCount);
+		for (std::size_t i = 0; i < unitCount; ++i)
+		{
+			outText[offset + i] = static_cast<wchar_t>(data[2 * i] | (data[2 * i + 1] << 8));
+		}
+		return;
+	}
+
+	outText.reserve(outText.size() + unitCount);
+	for (std::size_t i = 0; i < unitCount; ++i)
+	{
+		const char32_t c = data[2 * i] | (data[2 * i + 1] << 8);
+		if (IsHighSurrogate(c) && i + 1 < unitCount)
+		{
+			const char32_t low = data[2 * i + 2] | (data[2 * i + 3] << 8);
+			if (IsLowSurrogate(low))
+			{
+				AppendCodePoint(0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00), outText);
+				++i;
+				continue;
+			}
+		}
+		AppendCodePoint((IsHighSurrogate(c) || IsLowSurrogate(c)) ? kReplacementChar : c, outText);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void EncodeUtf8(const std::wstring & text, std::vector<unsigned char> & outData)
+{
+	outData.reserve(outData.size() + text.size());
+	const wchar_t * chars = text.data();
+	const std::size_t size = text.size();
+	std::size_t i = 0;
+	while (i < size)
+	{
+		const std::size_t asciiCount = CountAsciiChars(chars + i, size - i);
+		for (const std::size_t asciiEnd = i + asciiCount; i < asciiEnd; ++i)
+		{
+			outData.push_back(static_cast<unsigned char>(chars[i]));
+		}
+		if (i == size) break;
+
+		const char32_t c = ReadCodePoint(chars, size, i);
+		if (c < 0x800)
+		{
+			outData.push_back(static_cast<unsigned char>(0xC0 | (c >> 6)));
+		} else
+		if (c < 0x10000)
+		{
+			outData.push_back(static_cast<unsigned char>(0xE0 | (c >> 12)));
+			outData.push_back(static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F)));
+		} else
+		{
+			outData.push_back(static_cast<unsigned char>(0xF0 | (c >> 18)));
+			outData.push_back(static_cast<unsigned char>(0x80 | ((c >> 12) & 0x3F)));
+			outData.push_back(static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F)));
+		}
+		outData.push_back(static_cast<unsigned char>(0x80 | (c & 0x3F)));
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void EncodeUtf16LE(const std::wstring & text, std::vector<unsigned char> & outData)
+{
+	if (kIsWideCharUtf16)
+	{
+		const std::size_t offset = outData.size();
+		outData.resize(offset + 2 * text.size());
+		for (std::size_t i = 0; i < text.size(); ++i)
+		{
+			const std::uint32_t c = static_cast<std::uint32_t>(text[i]);
+			outData[offset + 2 * i] = static_cast<unsigned char>(c & 0xFF);
+			outData[offset + 2 * i + 1] = static_cast<unsigned char>((c >> 8) & 0xFF);
+		}
+		return;
+	}
+
+	outData.reserve(outData.size() + 2 * text.size());
+	const auto appendUnit = [&outData](char32_t unit)
+	{
+		outData.push_back(static_cast<unsigned char>(unit & 0xFF));
+		outData.push_back(static_cast<unsigned char>((unit >> 8) & 0xFF));
+	};
+	std::size_t i = 0;
+	while (i < text.size())
+	{
+		const char32_t c = ReadCodePoint(text.data(), text.size(), i);
+		if (c > 0xFFFF)
+		{
+			appendUnit(0xD800 + ((c - 0x10000) >> 10));
+			appendUnit(0xDC00 + ((c - 0x10000) & 0x3FF));
+		} else
+		{
+			appendUnit(c);
+		}
+	}
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+TextEncoding
+DecodeText(const unsigned char * data, std::size_t size, std::wstring & outText)
+{
+	outText.clear();
+	if (size >= sizeof(kUtf16LEBom) && std::memcmp(data, kUtf16LEBom, sizeof(kUtf16LEBom)) == 0)
+	{
+		DecodeUtf16LE(data + sizeof(kUtf16LEBom), size - sizeof(kUtf16LEBom), outText);
+		return TextEncoding::Utf16LE;
+	}
+
+	if (size >= sizeof(kUtf8Bom) && std::memcmp(data, kUtf8Bom, sizeof(kUtf8Bom)) == 0)
+	{
+		data += sizeof(kUtf8Bom);
+		size -= sizeof(kUtf8Bom);
+	}
+	DecodeUtf8(data, size, outText);
+	return TextEncoding::Utf8;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+EncodeText(const std::wstring & text, TextEncoding encoding, std::vector<unsigned char> & outData)
+{
+	outData.clear();
+	switch (encoding)
+	{
+	case TextEncoding::Utf16LE:
+		outData.assign(std::begin(kUtf16LEBom), std::end(kUtf16LEBom));
+		EncodeUtf16LE(text, outData);
+		break;
+	case TextEncoding::Utf8:
+		outData.assign(std::begin(kUtf8Bom), std::end(kUtf8Bom));
+		EncodeUtf8(text, outData);
+		break;
+	}
+}
+
+}}
\ No newline at end of file
@@ -0,0 +1,178 @@
+//
+// Copyright  20162020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include "neatcommon/system/TextFormat.h"
+
+namespace neatcommon {
+namespace system {
+
+//=====================================================================================================================
+// CFormatArg
+//=====================================================================================================================
+
+//---------------------------------------------------------------------------------------------------------------------
+const wchar_t *
+CFormatArg::GetText(wchar_t (&scratch)[kMaxIntegerLength], std::size_t & outLength) const
+{
+	if (type == Type::String)
+	{
+		outLength = length;
+		return text;
+	}
+
+	// digits are written backwards from the end of the scratch buffer
+	const bool isNegative = (type == Type::Signed) && (signedValue < 0);
+	unsigned long long value = (type == Type::Signed) ?
+		(isNegative ? 0 - static_cast<unsigned long long>(signedValue) : static_cast<unsigned long long>(signedValue)) :
+		unsignedValue;
+
+	wchar_t * p = scratch + kMaxIntegerLength;
+	do
+	{
+		*--p = static_cast<wchar_t>(L'0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	if (isNegative) *--p = L'-';
+
+	outLength = static_cast<std::size_t>(scratch + kMaxIntegerLength - p);
+	return p;
+}
+
+
+
+//=====================================================================================================================
+// CFormatTemplate
+//=====================================================================================================================
+
+//---------------------------------------------------------------------------------------------------------------------
+CFormatTemplate::CFormatTemplate(const wchar_t * fmtString) : fmtString(fmtString)
+{
+	const std::size_t size = std::wcslen(fmtString);
+	std::size_t prev = 0;
+	const wchar_t * pos = std::wcschr(fmtString, L'%');
+	while (pos != nullptr)
+	{
+		const std::size_t start = static_cast<std::size_t>(pos - fmtString);
+		if (start > prev)
+		{
+			segments.push_back(Segment{ prev, start - prev, 0 });
+		}
+
+		const wchar_t * end = std::wcschr(pos + 1, L'%');
+		if (end == nullptr)
+		{
+			// unterminated placeholder, the rest of the string is dropped
+			ASSERT(false);
+			prev = size;
+			break;
+		}
+
+		if (end == pos + 1)
+		{
+			segments.push_back(Segment{ start, 1, 0 });
+		} else
+		{
+			std::size_t argNumber = 0;
+			for (const wchar_t * p = pos + 1; p < end && *p >= L'0' && *p <= L'9'; ++p)
+			{
+				argNumber = argNumber * 10 + (*p - L'0');
+			}
+			ASSERT(argNumber > 0);
+			if (argNumber > 0)
+			{
+				segments.push_back(Segment{ 0, 0, argNumber });
+			}
+		}
+
+		prev = static_cast<std::size_t>(end - fmtString) + 1;
+		pos = std::wcschr(end + 1, L'%');
+	}
+
+	if (prev < size)
+	{
+		segments.push_back(Segment{ prev, size - prev, 0 });
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+std::size_t
+CFormatTemplate::Render(wchar_t * buffer, std::size_t bufferSize, const CFormatArg * args, std::size_t argCount) const
+{
+	if (bufferSize == 0) return 0;
+
+	std::size_t length = 0;
+	const std::size_t capacity = bufferSize - 1;
+	for (const Segment & segment : segments)
+	{
+		const wchar_t * text = fmtString + segment.offset;
+		std::size_t textLength = segment.length;
+		wchar_t scratch[CFormatArg::kMaxIntegerLength];
+		if (segment.argNumber > 0)
+		{
+			// placeholders without a matching argument are left empty
+			ASSERT(segment.argNumber <= argCount);
+			if (segment.argNumber > argCount) continue;
+			text = args[segment.argNumber - 1].GetText(scratch, textLength);
+		}
+
+		const std::size_t n = (textLength < capacity - length) ? textLength : capacity - length;
+		std::copy(text, text + n, buffer + length);
+		length += n;
+		if (length == capacity) break;
+	}
+
+	buffer[length] = L'\0';
+	return length;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+CFormatTemplate::Append(std::wstring & outString, const CFormatArg * args, std::size_t argCount) const
+{
+	for (const Segment & segment : segments)
+	{
+		if (segment.argNumber == 0)
+		{
+			outString.append(fmtString + segment.offset, segment.length);
+		} else
+		if (segment.argNumber <= argCount)
+		{
+			wchar_t scratch[CFormatArg::kMaxIntegerLength];
+			std::size_t textLength = 0;
+			const wchar_t * text = args[segment.argNumber - 1].GetText(scratch, textLength);
+			outString.append(text, textLength);
+		} else
+		{
+			ASSERT(false);
+		}
+	}
+}
+
+
+
+//=====================================================================================================================
+// CFormatter
+//=====================================================================================================================
+
+//---------------------------------------------------------------------------------------------------------------------
+std::wstring CFormatter::str() const
+{
+	std::vector<CFormatArg> args(values.begin(), values.end());
+	std::wstring res;
+	CFormatTemplate(fmtString.c_str()).Append(res, args.data(), args.size());
+	return res;
+}
+
+}}
\ No newline at end of file
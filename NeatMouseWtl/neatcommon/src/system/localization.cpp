@@ -15,187 +15,39 @@
 namespace neatcommon {
 namespace system {
 
-//=====================================================================================================================
-// CFormatter
-//=====================================================================================================================
-
-//---------------------------------------------------------------------------------------------------------------------
-std::wstring CFormatter::str() const
-{
-	std::wstring res;
-	size_t prev = 0;
-	size_t pos = fmtString.find(L'%');
-	while (pos != fmtString.npos)
-	{
-		if (pos > prev)
-			res.append(fmtString.substr(prev, pos - prev));
-		size_t pos1 = fmtString.find(L'%', pos + 1);
-		if (pos1 - pos == 1)
-			res.append(L"%");
-		else
-		{
-			if (pos1 == fmtString.npos)
-			{
-				prev = fmtString.size();
-				//assert here
-				break;
-			}
-			size_t paramNum = from_string_def(fmtString.substr(pos + 1, pos1 - pos - 1), 0);
-			if (paramNum > 0 && paramNum <= values.size())
-			{
-				res.append(values[paramNum - 1]);
-			} else
-			{
-				// assert here
-			}
-		}
-		prev = pos1 + 1;
-		pos = fmtString.find(L'%', prev);
-	}
-	if (prev < fmtString.size())
-	{
-		res.append(fmtString.substr(prev, fmtString.size() - prev));
-	}
-	return res;
-}
-
-
-
-//=====================================================================================================================
-// LocalizeSection
-//=====================================================================================================================
-
-//---------------------------------------------------------------------------------------------------------------------
-LocalizeSection::LocalizeSection() : defaultString(L"{}")
-{}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-void
-LocalizeSection::Clear()
-{
-	sections.clear();
-	values.clear();
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-const std::wstring &
-LocalizeSection::GetValue(const std::string & value) const
-{
-	std::map<std::string, std::wstring>::const_iterator it = values.find(value);
-	if (it != values.end())
-		return it->second;
-	else
-	{
-		ASSERT(false);
-		return defaultString;
-	}
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-const LocalizeSection::Ptr
-LocalizeSection::GetSection(const std::string & section) const
-{
-	std::map<std::string, LocalizeSection::Ptr>::const_iterator it = sections.find(section);
-	return (it != sections.end()) ? it->second : LocalizeSection::Ptr();
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-LocalizeSection::Ptr
-LocalizeSection::GetSection(const std::string & section)
-{
-	std::map<std::string, LocalizeSection::Ptr>::iterator it = sections.find(section);
-	return (it != sections.end()) ? it->second : LocalizeSection::Ptr();
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-LocalizeSection::Ptr
-LocalizeSection::AddSection(const std::string & name)
-{
-	LocalizeSection::Ptr res = std::make_shared<LocalizeSection>();
-	sections.emplace(name, res);
-	return res;
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-void
-LocalizeSection::SetValue(const std::string & name, const std::wstring & value)
-{
-	values.emplace(name, value);
-}
-
-
-
 //=====================================================================================================================
 // CLocalizer
 //=====================================================================================================================
 
 //---------------------------------------------------------------------------------------------------------------------
-CLocalizer::CLocalizer() : defaultString(L"{}"), section(std::make_shared<LocalizeSection>())
+CLocalizer::CLocalizer() : defaultString(L"{}")
 {}
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void
-CLocalizer::SetValue(const std::string & path, const std::wstring & value)
+const wchar_t *
+CLocalizer::GetValue(std::uint32_t keyHash, const char * path) const
 {
-	const std::vector<std::string> & splits = SplitString(path, ".");
-	LocalizeSection::Ptr currentSection = section;
-	for (size_t i = 0; i < splits.size() - 1; i++)
+	const wchar_t * value = pack.GetValue(keyHash, path);
+	if (value == nullptr)
 	{
-		LocalizeSection::Ptr previousSection = currentSection;
-		currentSection = currentSection->GetSection(splits[i]);
-		if (!currentSection) currentSection = previousSection->AddSection(splits[i]);
+		ASSERT(false);
+		return defaultString.c_str();
 	}
-	return currentSection->SetValue(splits[splits.size() - 1], value);
+	return value;
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-const std::wstring &
+const wchar_t *
 CLocalizer::GetValue(const std::string & path) const
 {
-	const std::vector<std::string> & splits = SplitString(path, ".");
-	LocalizeSection::Ptr currentSection = section;
-	for (size_t i = 0; i < splits.size() - 1; i++)
-	{
-		currentSection = currentSection->GetSection(splits[i]);
-		if (!currentSection)
-		{
-			ASSERT(false);
-			return defaultString;
-		}
-	}
-	return currentSection->GetValue(splits[splits.size() - 1]);
-}
-
-
-//---------------------------------------------------------------------------------------------------------------------
-void
-CLocalizer::loadFromIniFile(MyIniFile & iniFile)
-{
-	section->Clear();
-	std::vector<std::wstring> sections;
-	iniFile.enumerateSections(sections);
-	for (const std::wstring & s : sections)
-	{
-		for (const auto & aValue: iniFile.getSection(s))
-		{
-			std::string ss;
-			wstring2string(s + L"." + aValue.first, ss);
-			SetValue(ss, aValue.second);
-		}
-	}
+	return GetValue(HashLocalizationKey(path.c_str()), path.c_str());
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void
+bool
 CLocalizer::load(UINT resourceId, const std::wstring & iResourceType)
 {
 	HRSRC hrsrc = FindResource(0, MAKEINTRESOURCE(resourceId), iResourceType.c_str());
@@ -205,23 +57,39 @@ CLocalizer::load(UINT resourceId, const std::wstring & iResourceType)
 		HGLOBAL hResourceLoaded = LoadResource(NULL, hrsrc);
 		if (hResourceLoaded != NULL)
 		{
-			LPWSTR str = static_cast<LPWSTR>(LockResource(hResourceLoaded));
-			MyIniFile iniFile;
-
-			iniFile.loadFromBuffer(std::wstring(str, sz / sizeof(TCHAR)).c_str());
-			loadFromIniFile(iniFile);
+			// the resource stays mapped for the lifetime of the module, so the pack is used in place
+			LocalePack newPack;
+			if (newPack.Attach(LockResource(hResourceLoaded), sz))
+			{
+				pack = newPack;
+				ownedPack.clear();
+				return true;
+			}
 		}
 	}
+	return false;
 }
 
 
 //---------------------------------------------------------------------------------------------------------------------
-void
+bool
 CLocalizer::load(const std::wstring & fileName)
 {
 	MyIniFile iniFile;
 	iniFile.load(fileName);
-	loadFromIniFile(iniFile);
+
+	std::vector<unsigned char> data;
+	std::string error;
+	LocalePack newPack;
+	if (!BuildLocalePack(iniFile, data, error) || !newPack.Attach(data.data(), data.size()))
+	{
+		return false;
+	}
+
+	// swapping keeps the buffer the view points to
+	ownedPack.swap(data);
+	pack = newPack;
+	return true;
 }
 
 
@@ -16,6 +16,20 @@ namespace ui {
 
 volatile int CGdiPlusInitializer::m_GdiPlusPresent = -1;
 
+namespace {
+
+//---------------------------------------------------------------------------------------------------------------------
+BOOL CALLBACK EnumPngResource(HMODULE /*hModule*/, LPCTSTR /*lpType*/, LPTSTR lpName, LONG_PTR lParam)
+{
+	if (IS_INTRESOURCE(lpName))
+	{
+		reinterpret_cast<std::vector<UINT> *>(lParam)->push_back(static_cast<UINT>(reinterpret_cast<ULONG_PTR>(lpName)));
+	}
+	return TRUE;
+}
+
+}
+
 
 //---------------------------------------------------------------------------------------------------------------------
 void SetMenuItemBitmapCallbackMode(CMenuHandle hmenu, UINT id, CBitmapHandle bitmap, BOOL byPosition)
@@ -144,6 +158,79 @@ HBITMAP AtlLoadGdiplusImage(ATL::_U_STRINGorID bitmap, ATL::_U_STRINGorID type =
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+HBITMAP LoadPremultipliedPng(UINT id, UINT scale)
+{
+	if (!CGdiPlusInitializer::IsGdiPlusPresent() || scale == 0)
+	{
+		return NULL;
+	}
+
+	WTL::CResource res;
+	if (!res.Load(_T("PNG"), id)) return NULL;
+	const DWORD dwSize = res.GetSize();
+	HGLOBAL hMemory = ::GlobalAlloc(GMEM_MOVEABLE, dwSize);
+	if (hMemory == NULL) return NULL;
+	::memcpy(::GlobalLock(hMemory), res.Lock(), dwSize);
+	::GlobalUnlock(hMemory);
+	IStream * pStream = NULL;
+	if (FAILED(::CreateStreamOnHGlobal(hMemory, TRUE, &pStream)))
+	{
+		::GlobalFree(hMemory);
+		return NULL;
+	}
+	Gdiplus::Bitmap source(pStream);
+	pStream->Release();
+	if (source.GetLastStatus() != Gdiplus::Ok) return NULL;
+
+	const INT w = static_cast<INT>(source.GetWidth() * scale / 100);
+	const INT h = static_cast<INT>(source.GetHeight() * scale / 100);
+	if (w <= 0 || h <= 0) return NULL;
+
+	BITMAPINFO bmi{};
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = w;
+	bmi.bmiHeader.biHeight = -h; // top-down, as GDI+ lays out the pixels
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void * pvBits = NULL;
+	HBITMAP hBitmap = ::CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &pvBits, NULL, 0);
+	if (hBitmap == NULL) return NULL;
+
+	Gdiplus::Status status;
+	if (scale == 100)
+	{
+		// let GDI+ convert the pixels straight into the DIB section
+		Gdiplus::BitmapData data{};
+		data.Width = w;
+		data.Height = h;
+		data.Stride = w * 4;
+		data.PixelFormat = PixelFormat32bppPARGB;
+		data.Scan0 = pvBits;
+		Gdiplus::Rect rect(0, 0, w, h);
+		status = source.LockBits(&rect, Gdiplus::ImageLockModeRead | Gdiplus::ImageLockModeUserInputBuf, PixelFormat32bppPARGB, &data);
+		if (status == Gdiplus::Ok) status = source.UnlockBits(&data);
+	} else
+	{
+		Gdiplus::Bitmap target(w, h, w * 4, PixelFormat32bppPARGB, static_cast<BYTE *>(pvBits));
+		Gdiplus::Graphics graphics(&target);
+		graphics.SetCompositingMode(Gdiplus::CompositingModeSourceCopy);
+		graphics.SetInterpolationMode(Gdiplus::InterpolationModeHighQualityBicubic);
+		graphics.SetPixelOffsetMode(Gdiplus::PixelOffsetModeHalf);
+		status = graphics.DrawImage(&source, 0, 0, w, h);
+	}
+
+	if (status != Gdiplus::Ok)
+	{
+		::DeleteObject(hBitmap);
+		return NULL;
+	}
+	return hBitmap;
+}
+
+
 //=====================================================================================================================
 // CGdiPlusInitializer
 //=====================================================================================================================
@@ -218,25 +305,95 @@ CGdiPlusInitializer::~CGdiPlusInitializer()
 //---------------------------------------------------------------------------------------------------------------------
 CImageManager::~CImageManager()
 {
-	for (const auto & kv : bitmaps)
+	StopPreload();
+	for (const ScaledBitmaps & scaled : bitmaps)
 	{
-		DeleteObject(kv.second);
+		for (const Slot & slot : scaled.slots)
+		{
+			if (slot.bitmap != NULL) DeleteObject(slot.bitmap);
+		}
 	}
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+CImageManager::Slot &
+CImageManager::GetSlot(UINT id, UINT scale)
+{
+	auto it = std::find_if(bitmaps.begin(), bitmaps.end(), [scale](const ScaledBitmaps & scaled) { return scaled.scale == scale; });
+	if (it == bitmaps.end())
+	{
+		bitmaps.push_back(ScaledBitmaps{ scale, {} });
+		it = bitmaps.end() - 1;
+	}
+	if (id >= it->slots.size()) it->slots.resize(id + 1);
+	return it->slots[id];
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 HBITMAP
-CImageManager::GetBitmapFromPng(UINT id)
+CImageManager::StoreBitmap(UINT id, UINT scale, HBITMAP bitmap)
 {
-	std::map<UINT, HBITMAP>::iterator it = bitmaps.find(id);
-	if (it != bitmaps.end())
+	std::lock_guard<std::mutex> lock(bitmapsMutex);
+	Slot & slot = GetSlot(id, scale);
+	if (slot.loaded)
+	{
+		// the other thread has decoded the same image meanwhile
+		if (bitmap != NULL) DeleteObject(bitmap);
+	} else
 	{
-		return it->second;
+		slot.bitmap = bitmap;
+		slot.loaded = true;
 	}
-	HBITMAP b = AtlLoadGdiplusImage(id, _T("PNG"));
-	bitmaps.emplace(id, b);
-	return b;
+	return slot.bitmap;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+HBITMAP
+CImageManager::GetBitmapFromPng(UINT id, UINT scale)
+{
+	{
+		std::lock_guard<std::mutex> lock(bitmapsMutex);
+		const Slot & slot = GetSlot(id, scale);
+		if (slot.loaded) return slot.bitmap;
+	}
+	// the lock isn't held while decoding, so that the preloading goes on
+	return StoreBitmap(id, scale, LoadPremultipliedPng(id, scale));
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+CImageManager::Preload(UINT scale)
+{
+	if (preloadThread.joinable()) return;
+
+	preloadStopped = false;
+	preloadThread = std::thread([this, scale]()
+	{
+		std::vector<UINT> ids;
+		::EnumResourceNames(_Module.GetResourceInstance(), _T("PNG"), EnumPngResource, reinterpret_cast<LONG_PTR>(&ids));
+		for (const UINT id : ids)
+		{
+			if (preloadStopped) break;
+			{
+				std::lock_guard<std::mutex> lock(bitmapsMutex);
+				if (GetSlot(id, scale).loaded) continue;
+			}
+			StoreBitmap(id, scale, LoadPremultipliedPng(id, scale));
+		}
+	});
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+CImageManager::StopPreload()
+{
+	preloadStopped = true;
+	if (preloadThread.joinable()) preloadThread.join();
 }
 
 
@@ -253,12 +410,20 @@ CMenuBitmapsManager::CMenuBitmapsManager(int cx, int cy)
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<CMenuBitmapsManager::Icon_t>::iterator
+CMenuBitmapsManager::FindIcon(UINT id)
+{
+	return std::lower_bound(icons.begin(), icons.end(), id, [](const Icon_t & icon, UINT anId) { return icon.first < anId; });
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 CBitmapHandle
 CMenuBitmapsManager::GetBitmap(UINT id)
 {
-	std::map<UINT, CBitmapHandle>::iterator it = icons.find(id);
-	return (it == icons.end()) ? CBitmapHandle() : it->second;
+	const auto it = FindIcon(id);
+	return (it == icons.end() || it->first != id) ? CBitmapHandle() : it->second;
 }
 
 
@@ -266,12 +431,18 @@ CMenuBitmapsManager::GetBitmap(UINT id)
 void
 CMenuBitmapsManager::SetBitmap(UINT id, CBitmapHandle bmp)
 {
+	const auto it = FindIcon(id);
+	const bool found = (it != icons.end()) && (it->first == id);
 	if (bmp.IsNull())
 	{
-		icons.erase(id);
+		if (found) icons.erase(it);
+	} else
+	if (found)
+	{
+		it->second = bmp;
 	} else
 	{
-		icons[id] = bmp;
+		icons.emplace(it, id, bmp);
 	}
 }
 
@@ -285,8 +456,8 @@ CMenuBitmapsManager::Measure(LPMEASUREITEMSTRUCT lpmis)
 		return;
 	}
 
-	std::map<UINT, CBitmapHandle>::iterator it = icons.find(lpmis->itemID);
-	if (it == icons.end())
+	const auto it = FindIcon(lpmis->itemID);
+	if (it == icons.end() || it->first != lpmis->itemID)
 	{
 		return;
 	}
@@ -308,8 +479,8 @@ CMenuBitmapsManager::Draw(LPDRAWITEMSTRUCT lpdis)
 		return; // not for a menu
 	}
 
-	std::map<UINT, CBitmapHandle>::iterator it = icons.find(lpdis->itemID);
-	if (it == icons.end())
+	const auto it = FindIcon(lpdis->itemID);
+	if (it == icons.end() || it->first != lpdis->itemID)
 	{
 		return;
 	}
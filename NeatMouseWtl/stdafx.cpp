@@ -23,7 +23,7 @@ HBITMAP SafeLoadPng(UINT id)
 
 
 //-----------------------------------------------------------------------------
-LPCTSTR _(const std::string & name)
+LPCTSTR LocalizeKey(std::uint32_t keyHash, const char * key)
 {
-	return neatmouse::logic::MainSingleton::Instance().GetLocalizer().GetValue(name).c_str();
+	return neatmouse::logic::MainSingleton::Instance().GetLocalizer().GetValue(keyHash, key);
 }
\ No newline at end of file
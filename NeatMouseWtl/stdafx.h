@@ -34,6 +34,7 @@
 #define ID_COMBO_PRESETS            ID_TOOLBAR_START + 100
 
 #define NEAT_TRAY_CALLBACK          WM_USER + 1000
+#define NEAT_SETTINGS_CHANGED       WM_USER + 1001
 
 #include <atlbase.h>
 #include <atlapp.h>
@@ -75,4 +76,7 @@ extern CAppModule _Module;
 
 HBITMAP SafeLoadPng(UINT id);
 
-LPCTSTR _(const std::string & name);
\ No newline at end of file
+LPCTSTR LocalizeKey(std::uint32_t keyHash, const char * key);
+
+// the key is hashed at compile time, the lookup itself is allocation-free
+#define _(key) LocalizeKey(std::integral_constant<std::uint32_t, neatcommon::system::HashLocalizationKey(key)>::value, key)
\ No newline at end of file
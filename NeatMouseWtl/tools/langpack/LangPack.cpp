@@ -0,0 +1,72 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+// Compiles a .lng file into the binary locale pack embedded into the NeatMouse resources.
+// Usage: LangPack <input.lng> <output.nmlp>
+// Errors are reported in the format understood by MSBuild, so they show up in the Error List.
+
+#include "stdafx.h"
+
+#include <cstdio>
+
+#include "neatcommon/system/IniFiles.h"
+#include "neatcommon/system/LocalePack.h"
+
+namespace {
+
+//---------------------------------------------------------------------------------------------------------------------
+bool WriteFile(const std::wstring & fileName, const std::vector<unsigned char> & data)
+{
+	const size_t pos = fileName.find_last_of(L'\\');
+	if (pos != fileName.npos)
+	{
+		CreateDirectory(fileName.substr(0, pos).c_str(), NULL);
+	}
+
+	FILE * fileHandle;
+	if (_wfopen_s(&fileHandle, fileName.c_str(), L"wb")) return false;
+	const bool res = fwrite(data.data(), sizeof(unsigned char), data.size(), fileHandle) == data.size();
+	return (fclose(fileHandle) == 0) && res;
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+int wmain(int argc, wchar_t * argv[])
+{
+	if (argc != 3)
+	{
+		fwprintf(stderr, L"Usage: LangPack <input.lng> <output.nmlp>\n");
+		return 1;
+	}
+
+	neatcommon::system::MyIniFile iniFile;
+	if (!iniFile.load(argv[1]))
+	{
+		fwprintf(stderr, L"%s : error LP0001: cannot read the file\n", argv[1]);
+		return 1;
+	}
+
+	std::vector<unsigned char> data;
+	std::string error;
+	if (!neatcommon::system::BuildLocalePack(iniFile, data, error))
+	{
+		fwprintf(stderr, L"%s : error LP0002: %S\n", argv[1], error.c_str());
+		return 1;
+	}
+
+	if (!WriteFile(argv[2], data))
+	{
+		fwprintf(stderr, L"%s : error LP0003: cannot write the file\n", argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
\ No newline at end of file
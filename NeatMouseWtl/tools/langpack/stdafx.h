@@ -0,0 +1,23 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+#define WINVER        0x0501
+#define _WIN32_WINNT  0x0501
+
+#include <windows.h>
+
+#include <assert.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#define ASSERT(x) assert(x)
\ No newline at end of file
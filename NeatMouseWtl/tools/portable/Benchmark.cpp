@@ -0,0 +1,201 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+// Times the portable pieces of the logic and prints the results to the standard output as JSON, so that runs can be
+// compared by a script. Usage: portable_benchmark [--min-time-ms N], N being the time each case runs for at least
+// (200 ms by default).
+
+#include "stdafx.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "logic/GridTargeting.h"
+#include "neatcommon/system/TextEncoding.h"
+#include "neatcommon/system/TextFormat.h"
+
+using neatcommon::system::CFormatArg;
+using neatcommon::system::CFormatTemplate;
+using neatcommon::system::CFormatter;
+using neatcommon::system::TextEncoding;
+using neatmouse::logic::GridTargeting;
+
+namespace {
+
+// results folded into this value can't be optimized out
+volatile std::size_t g_sink = 0;
+
+struct Result
+{
+	const char * name;
+	unsigned long long iterations;
+	double nsPerIteration;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Runs the case in batches of growing size until a batch lasts at least the minimum time; the last batch is reported
+template <class Case>
+Result
+Run(const char * name, std::chrono::nanoseconds minTime, Case body)
+{
+	body();
+
+	unsigned long long iterations = 1;
+	for (;;)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (unsigned long long i = 0; i < iterations; ++i)
+		{
+			body();
+		}
+		const std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+		if ((elapsed >= minTime) || (iterations >= (1ULL << 40)))
+		{
+			return Result{ name, iterations, static_cast<double>(elapsed.count()) / iterations };
+		}
+		iterations *= (elapsed * 10 < minTime) ? 10 : 2;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Text of the size of a language file, mixing ASCII keys with accented and Cyrillic values
+std::wstring
+MakeLanguageText()
+{
+	std::wstring text;
+	for (int i = 0; i < 100; ++i)
+	{
+		text += L"[Section";
+		text += std::to_wstring(i);
+		text += L"]\nCaption=Param\u00e8tres de la souris \u2014 \u041d\u0430\u0441\u0442\u0440\u043e\u0439\u043a\u0438\n";
+	}
+	return text;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+Print(const std::vector<Result> & results, std::chrono::nanoseconds minTime)
+{
+	std::printf("{\n");
+	std::printf("  \"context\": {\n");
+	std::printf("    \"min_time_ms\": %lld,\n", static_cast<long long>(minTime.count() / 1000000));
+	std::printf("    \"wchar_bits\": %u\n", static_cast<unsigned>(sizeof(wchar_t) * 8));
+	std::printf("  },\n");
+	std::printf("  \"benchmarks\": [\n");
+	for (std::size_t i = 0; i < results.size(); ++i)
+	{
+		std::printf("    { \"name\": \"%s\", \"iterations\": %llu, \"real_time\": %.1f, \"time_unit\": \"ns\" }%s\n",
+			results[i].name, results[i].iterations, results[i].nsPerIteration, (i + 1 < results.size()) ? "," : "");
+	}
+	std::printf("  ]\n");
+	std::printf("}\n");
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+int main(int argc, char * argv[])
+{
+	std::chrono::nanoseconds minTime = std::chrono::milliseconds(200);
+	for (int i = 1; i < argc; ++i)
+	{
+		if ((std::strcmp(argv[i], "--min-time-ms") == 0) && (i + 1 < argc))
+		{
+			minTime = std::chrono::milliseconds(std::atol(argv[++i]));
+		} else
+		{
+			std::fprintf(stderr, "usage: %s [--min-time-ms N]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	const std::wstring text = MakeLanguageText();
+	std::vector<unsigned char> utf8;
+	std::vector<unsigned char> utf16;
+	neatcommon::system::EncodeText(text, TextEncoding::Utf8, utf8);
+	neatcommon::system::EncodeText(text, TextEncoding::Utf16LE, utf16);
+
+	const wchar_t * const kFormat = L"Key %1% is bound to %2% (%3%%%)";
+	const CFormatTemplate format(kFormat);
+	const std::wstring action = L"Left button";
+
+	std::vector<Result> results;
+
+	results.push_back(Run("text_encoding/decode_utf8", minTime, [&] {
+		std::wstring decoded;
+		neatcommon::system::DecodeText(utf8.data(), utf8.size(), decoded);
+		g_sink += decoded.size();
+	}));
+	results.push_back(Run("text_encoding/decode_utf16le", minTime, [&] {
+		std::wstring decoded;
+		neatcommon::system::DecodeText(utf16.data(), utf16.size(), decoded);
+		g_sink += decoded.size();
+	}));
+	results.push_back(Run("text_encoding/encode_utf8", minTime, [&] {
+		std::vector<unsigned char> data;
+		neatcommon::system::EncodeText(text, TextEncoding::Utf8, data);
+		g_sink += data.size();
+	}));
+	results.push_back(Run("text_encoding/encode_utf16le", minTime, [&] {
+		std::vector<unsigned char> data;
+		neatcommon::system::EncodeText(text, TextEncoding::Utf16LE, data);
+		g_sink += data.size();
+	}));
+
+	results.push_back(Run("format_template/parse", minTime, [&] {
+		const CFormatTemplate parsed(kFormat);
+		wchar_t buffer[8];
+		g_sink += parsed.Render(buffer, 8, { 0 });
+	}));
+	results.push_back(Run("format_template/render", minTime, [&] {
+		wchar_t buffer[128];
+		g_sink += format.Render(buffer, 128, { 113, action, -25 });
+	}));
+	results.push_back(Run("format_template/append", minTime, [&] {
+		const CFormatArg args[] = { 113, action, -25 };
+		std::wstring rendered;
+		format.Append(rendered, args, 3);
+		g_sink += rendered.size();
+	}));
+	results.push_back(Run("formatter/str", minTime, [&] {
+		g_sink += (CFormatter(kFormat) % 113 % action % -25).str().size();
+	}));
+
+	results.push_back(Run("grid_targeting/narrow_monitor_3x3", minTime, [&] {
+		GridTargeting targeting;
+		targeting.Start(RECT{ 0, 0, 3840, 2160 }, 3);
+		int step = 0;
+		while (targeting.CanNarrow())
+		{
+			targeting.Narrow(step % 3 - 1, (step / 3) % 3 - 1);
+			++step;
+		}
+		g_sink += static_cast<std::size_t>(targeting.GetTarget().x);
+	}));
+	results.push_back(Run("grid_targeting/get_cell", minTime, [&] {
+		const RECT region = { 17, 5, 1937, 1085 };
+		for (int column = 0; column < 3; ++column)
+		{
+			for (int row = 0; row < 3; ++row)
+			{
+				g_sink += static_cast<std::size_t>(GridTargeting::GetCell(region, 3, column, row).right);
+			}
+		}
+	}));
+
+	Print(results, minTime);
+	return 0;
+}
\ No newline at end of file
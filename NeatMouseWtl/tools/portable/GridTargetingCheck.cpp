@@ -0,0 +1,27 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+// Runs the self-check of the grid targeting math; the exit code is 0 if it passes.
+
+#include "stdafx.h"
+
+#include <cstdio>
+
+#include "logic/GridTargeting.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+int main()
+{
+	if (!neatmouse::logic::GridTargeting::SelfCheck())
+	{
+		std::fprintf(stderr, "GridTargeting::SelfCheck() failed\n");
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+// Drives RampUpCursorMover through the simulated clock and checks the trajectory it produces; the exit code is 0 if
+// it matches.
+
+#include "stdafx.h"
+
+#include <cstdio>
+
+#include "logic/RampUpCursorMover.h"
+#include "logic/SimulatedMotionClock.h"
+
+using neatmouse::logic::IMotionClock;
+using neatmouse::logic::MotionJitterStats;
+using neatmouse::logic::RampUpCursorMover;
+using neatmouse::logic::SimulatedMotionClock;
+
+namespace {
+
+// 16 steps: the initial delay rounded up to whole repeat periods
+const IMotionClock::Duration_t kInitialDelay = std::chrono::milliseconds(500);
+const IMotionClock::Duration_t kTick = std::chrono::milliseconds(33);
+const size_t kStepCount = 16;
+
+// real time after which the check gives up instead of hanging
+const std::chrono::milliseconds kTimeout(5000);
+
+struct Move
+{
+	LONG dx;
+	LONG dy;
+	IMotionClock::TimePoint_t time;
+};
+
+
+/**
+ * Moves performed by the mover, in the order of the motion thread
+ */
+class MoveRecorder
+{
+public:
+	explicit MoveRecorder(IMotionClock & clock) : m_clock(clock) {}
+
+	void Add(LONG dx, LONG dy)
+	{
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			m_moves.push_back(Move{ dx, dy, m_clock.Now() });
+		}
+		m_changed.notify_all();
+	}
+
+	bool WaitForCount(size_t count)
+	{
+		std::unique_lock<std::mutex> lk(m_mutex);
+		return m_changed.wait_for(lk, kTimeout, [this, count] { return m_moves.size() >= count; });
+	}
+
+	std::vector<Move> Take()
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		std::vector<Move> moves;
+		moves.swap(m_moves);
+		return moves;
+	}
+
+private:
+	IMotionClock & m_clock;
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::vector<Move> m_moves;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+bool
+Fail(const char * what)
+{
+	std::fprintf(stderr, "motion check failed: %s\n", what);
+	return false;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// Wakes the motion thread up at each of its deadlines until it stops waiting, lateBy after the first one
+bool
+RunMove(SimulatedMotionClock & clock, IMotionClock::Duration_t lateBy)
+{
+	IMotionClock::TimePoint_t deadline;
+	if (!clock.WaitForWaiter(kTimeout, deadline)) return Fail("the move doesn't wait for its second step");
+	clock.AdvanceTo(deadline + lateBy);
+
+	while (clock.WaitForWaiter(std::chrono::milliseconds(200), deadline))
+	{
+		clock.AdvanceTo(deadline);
+	}
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// The steps come exactly at start + n * tick, one move each
+bool
+CheckSteadyMove(SimulatedMotionClock & clock, RampUpCursorMover & mover, MoveRecorder & recorder)
+{
+	const IMotionClock::TimePoint_t start = clock.Now();
+	mover.moveAsync(3, -2);
+	if (!RunMove(clock, IMotionClock::Duration_t::zero())) return false;
+	if (!recorder.WaitForCount(kStepCount)) return Fail("the steady move has too few steps");
+
+	const std::vector<Move> moves = recorder.Take();
+	if (moves.size() != kStepCount) return Fail("the steady move has too many steps");
+	for (size_t i = 0; i < moves.size(); ++i)
+	{
+		if ((moves[i].dx != 3) || (moves[i].dy != -2)) return Fail("a step of the steady move has a wrong size");
+		if (moves[i].time != start + static_cast<long>(i) * kTick) return Fail("a step of the steady move is off time");
+	}
+
+	const MotionJitterStats stats = mover.getJitterStats();
+	if ((stats.ticks != kStepCount) || (stats.missedTicks != 0)) return Fail("wrong jitter stats of the steady move");
+	if (stats.meanLatenessUs != 0.0) return Fail("the steady move is late");
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// A wake-up two ticks late merges the missed steps into one move and keeps the total displacement
+bool
+CheckLateWakeUp(SimulatedMotionClock & clock, RampUpCursorMover & mover, MoveRecorder & recorder)
+{
+	const IMotionClock::TimePoint_t start = clock.Now();
+	mover.moveAsync(1, 1);
+	if (!RunMove(clock, 2 * kTick)) return false;
+	if (!recorder.WaitForCount(kStepCount - 2)) return Fail("the late move has too few steps");
+
+	const std::vector<Move> moves = recorder.Take();
+	if (moves.size() != kStepCount - 2) return Fail("the late move has too many steps");
+	if ((moves[1].dx != 3) || (moves[1].dy != 3)) return Fail("the missed steps aren't merged");
+	if (moves[1].time != start + 3 * kTick) return Fail("the merged step is off time");
+
+	LONG dx = 0;
+	LONG dy = 0;
+	for (const Move & move : moves)
+	{
+		dx += move.dx;
+		dy += move.dy;
+	}
+	if ((dx != static_cast<LONG>(kStepCount)) || (dy != static_cast<LONG>(kStepCount))) return Fail("the late move has a wrong displacement");
+
+	const MotionJitterStats stats = mover.getJitterStats();
+	if ((stats.ticks != 2 * kStepCount - 2) || (stats.missedTicks != 2)) return Fail("wrong jitter stats of the late move");
+	return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// A stop ends the move at once, and the next move starts from scratch
+bool
+CheckStopAndRestart(SimulatedMotionClock & clock, RampUpCursorMover & mover, MoveRecorder & recorder)
+{
+	mover.moveAsync(5, 0);
+	IMotionClock::TimePoint_t deadline;
+	if (!clock.WaitForWaiter(kTimeout, deadline)) return Fail("the stopped move doesn't wait for its second step");
+	if (!recorder.WaitForCount(1)) return Fail("the stopped move has no first step");
+
+	mover.stopMove();
+	mover.moveAsync(0, 7);
+	if (!recorder.WaitForCount(2)) return Fail("the restarted move has no first step");
+
+	const IMotionClock::TimePoint_t restart = clock.Now();
+	if (!RunMove(clock, IMotionClock::Duration_t::zero())) return false;
+	if (!recorder.WaitForCount(kStepCount + 1)) return Fail("the restarted move has too few steps");
+
+	const std::vector<Move> moves = recorder.Take();
+	if (moves.size() != kStepCount + 1) return Fail("the stopped move goes on");
+	if ((moves[0].dx != 5) || (moves[0].dy != 0)) return Fail("the stopped move has a wrong first step");
+	for (size_t i = 1; i < moves.size(); ++i)
+	{
+		if ((moves[i].dx != 0) || (moves[i].dy != 7)) return Fail("the stopped move goes on");
+		if (moves[i].time != restart + static_cast<long>(i - 1) * kTick) return Fail("a step of the restarted move is off time");
+	}
+	return true;
+}
+
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+int main()
+{
+	SimulatedMotionClock clock(kInitialDelay, kTick);
+	MoveRecorder recorder(clock);
+
+	RampUpCursorMover mover(clock);
+	mover.setMoveCallback([&recorder](LONG dx, LONG dy) { recorder.Add(dx, dy); });
+
+	if (!CheckSteadyMove(clock, mover, recorder)) return 1;
+	if (!CheckLateWakeUp(clock, mover, recorder)) return 1;
+	if (!CheckStopAndRestart(clock, mover, recorder)) return 1;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+// Thread scheduling of the portable build: the priority, MMCSS and affinity settings are Windows ones, so the threads
+// keep the default scheduling of the system.
+
+#include "stdafx.h"
+
+#include "logic/ThreadScheduling.h"
+
+namespace neatmouse {
+namespace logic {
+
+//---------------------------------------------------------------------------------------------------------------------
+ScopedThreadScheduling::ScopedThreadScheduling(const ThreadSchedulingOptions & options)
+{
+	Apply(options);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+ScopedThreadScheduling::~ScopedThreadScheduling()
+{
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+void
+ScopedThreadScheduling::Apply(const ThreadSchedulingOptions & /*options*/)
+{
+}
+
+}}
\ No newline at end of file
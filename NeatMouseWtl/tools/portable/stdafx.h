@@ -0,0 +1,41 @@
+//
+// Copyright  2020 Neat Decisions. All rights reserved.
+//
+// This file is part of NeatMouse.
+// The use and distribution terms for this software are covered by the
+// Microsoft Public License (http://opensource.org/licenses/MS-PL)
+// which can be found in the file LICENSE at the root folder.
+//
+
+#pragma once
+
+// Precompiled header of the portable build (see CMakeLists.txt at the root folder): the few Win32 types the portable
+// logic uses, with the sizes they have on Windows
+
+#include <assert.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef std::int32_t LONG;
+typedef std::uint32_t DWORD;
+typedef std::uintptr_t DWORD_PTR;
+typedef void * HANDLE;
+
+struct RECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+};
+
+struct POINT
+{
+	LONG x;
+	LONG y;
+};
+
+#define ASSERT(x) assert(x)
\ No newline at end of file